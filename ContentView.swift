@@ -28,8 +28,6 @@ struct ContentView: View {
     @StateObject private var predictor = FERPredictor(settings: InferenceSettings())
     @State private var showSettings = false
     @State private var predictions: [FacePrediction] = []
-    @State private var lastUIUpdate: Date = .distantPast
-    private let uiUpdateInterval: TimeInterval = 1.0 / 15.0  // 15fps
     
     var body: some View {
         GeometryReader { geometry in
@@ -119,6 +117,14 @@ struct ContentView: View {
                     .padding()
                     
                     Spacer()
+
+                    if settings.showTelemetry {
+                        HStack {
+                            TelemetryOverlay()
+                            Spacer()
+                        }
+                        .padding()
+                    }
                 }
             }
         }
@@ -145,15 +151,16 @@ struct ContentView: View {
             lifecycle.register(predictor: predictor)
 
             predictor.update(settings: settings)
+            // Runs on the camera pipeline's processing queue; predict() only queues the frame
+            // for the predictor's inference queue. Captures the object, not the view's wrapper
+            let frameSink = predictor
             coordinator.onFrameCapture = { pixelBuffer, faces, orientation in
-                predictor.predict(pixelBuffer: pixelBuffer, faces: faces, orientation: orientation)
+                frameSink.predict(pixelBuffer: pixelBuffer, faces: faces, orientation: orientation)
             }
             coordinator.start()
         }
-        .onReceive(predictor.$faceOutputs.receive(on: DispatchQueue.main)) { outputs in
-            let now = Date()
-            guard now.timeIntervalSince(lastUIUpdate) >= uiUpdateInterval else { return }
-            lastUIUpdate = now
+        .onReceive(predictor.$faceOutputs) { outputs in
+            // Already delivered on the main thread, at most 15 times a second, by the predictor's display link
             predictions = outputs
         }
         .onReceive(predictor.$probabilityHistory.receive(on: DispatchQueue.main)) { history in
@@ -162,11 +169,12 @@ struct ContentView: View {
                   settings.enableARGraph,
                   let manager = coordinator.arGraphManager else { return }
 
-            let faceTransform = coordinator.faces.first(where: { $0.transform != nil })?.transform
+            let faceTransform = predictor.detectedFaces.first(where: { $0.transform != nil })?.transform
             manager.update(history: history, faceTransform: faceTransform, settings: settings)
         }
-        .onReceive(coordinator.$faces.receive(on: DispatchQueue.main)) { faces in
-            // Keep AR surface aligned even when history hasn't changed
+        .onReceive(predictor.$detectedFaces) { faces in
+            // Keep AR surface aligned even when history hasn't changed; delivered by the
+            // predictor's display link, so at most once per refresh
             guard coordinator.isBackCamera,
                   settings.enableARGraph,
                   let manager = coordinator.arGraphManager else { return }
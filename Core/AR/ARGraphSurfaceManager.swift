@@ -14,7 +14,10 @@ class ARGraphSurfaceManager {
     private let arSession: ARSession
     private var anchorEntity: AnchorEntity?
     private var graphEntity: ProbabilityGraphEntity?
+    private var graphRenderer: MetalGraphRenderer?
     private var textureGenerator: GraphTextureGenerator?
+    private var renderScheduler: GraphRenderScheduler?
+    private var lastSubmittedHistory: [[Float]] = []
 
     private var isSetup: Bool = false
     private var lastUpdateTime: Date = .distantPast
@@ -47,11 +50,27 @@ class ARGraphSurfaceManager {
         anchor.addChild(entity)
         graphEntity = entity
 
-        // Create texture generator
-        textureGenerator = GraphTextureGenerator(size: CGSize(width: 512, height: 512))
-        guard textureGenerator != nil else {
-            Log.error("[ARGraphSurface] Failed to create texture generator")
-            return
+        // Draw the graph on the GPU straight into the surface's texture; fall back to the
+        // CoreGraphics texture generator if the Metal renderer is unavailable
+        if let renderer = MetalGraphRenderer(size: CGSize(width: 512, height: 512)) {
+            graphRenderer = renderer
+            entity.attach(drawableQueue: renderer.drawableQueue)
+        } else {
+            textureGenerator = GraphTextureGenerator(size: CGSize(width: 512, height: 512))
+            guard textureGenerator != nil else {
+                Log.error("[ARGraphSurface] Failed to create texture generator")
+                return
+            }
+        }
+
+        // Texture redraws follow history changes, capped at targetFPS, off the update path
+        renderScheduler = GraphRenderScheduler(maxFramesPerSecond: Float(targetFPS)) { [weak self] history in
+            guard let self = self else { return }
+            if let graphRenderer = self.graphRenderer {
+                graphRenderer.render(history: history)
+            } else if let texture = self.textureGenerator?.render(history: history) {
+                self.graphEntity?.updateTexture(texture)
+            }
         }
 
         isSetup = true
@@ -85,7 +104,13 @@ class ARGraphSurfaceManager {
             return
         }
 
-        // Throttle heavy work to target FPS
+        // Queue a texture redraw only when the history actually changed
+        if history != lastSubmittedHistory {
+            lastSubmittedHistory = history
+            renderScheduler?.submit(history)
+        }
+
+        // Throttle placement updates to target FPS
         let now = Date()
         let minInterval = 1.0 / targetFPS
         guard now.timeIntervalSince(lastUpdateTime) >= minInterval else {
@@ -99,12 +124,6 @@ class ARGraphSurfaceManager {
         }
         let cameraTransform = currentFrame.camera.transform
 
-        // Generate texture from probability history
-          if let textureGenerator = textureGenerator,
-              let texture = textureGenerator.render(history: history) {
-            graphEntity.updateTexture(texture)
-        }
-
         // Update entity configuration from settings
         let entityConfig = ProbabilityGraphEntity.Configuration(
             baseWidth: settings.graphSurfaceBaseWidth,
@@ -127,6 +146,7 @@ class ARGraphSurfaceManager {
     /// Cleanup resources and hide the graph
     func cleanup() {
         graphEntity?.hide()
+        lastSubmittedHistory = []
         textureGenerator?.clearCache()
         Log.info("[ARGraphSurface] Cleaned up")
     }
@@ -136,6 +156,10 @@ class ARGraphSurfaceManager {
         anchorEntity?.removeFromParent()
         anchorEntity = nil
         graphEntity = nil
+        renderScheduler?.invalidate()
+        renderScheduler = nil
+        lastSubmittedHistory = []
+        graphRenderer = nil
         textureGenerator = nil
         isSetup = false
         Log.info("[ARGraphSurface] Removed from scene")
@@ -0,0 +1,101 @@
+import Foundation
+import QuartzCore
+import os
+
+/// Coalesces probability-history updates and redraws the graph at a capped rate
+/// - `submit(_:)` may be called from any thread; it only swaps the pending history under an
+///   unfair lock and never waits for a redraw
+/// - A display link capped at `maxFramesPerSecond` draws the newest pending history, so the
+///   redraw rate follows the display / cap instead of the inference rate
+/// - The link pauses while nothing is pending and resumes on the next submit
+/// - Mirrors `example_/RenderScheduler.h`; redraws run on the main thread because
+///   `ImageRenderer` is main-actor bound
+@MainActor
+final class GraphRenderScheduler {
+
+    // MARK: - Types
+
+    private struct Pending {
+        var history: [[Float]]?
+        var isRunning = false
+    }
+
+    // MARK: - Properties
+
+    private let pending = OSAllocatedUnfairLock(initialState: Pending())
+    private let render: @MainActor ([[Float]]) -> Void
+    private var displayLink: CADisplayLink?
+    private(set) var renderedCount = 0
+
+    let maxFramesPerSecond: Float
+
+    // MARK: - Initialization
+
+    init(maxFramesPerSecond: Float = 15, render: @escaping @MainActor ([[Float]]) -> Void) {
+        self.maxFramesPerSecond = maxFramesPerSecond
+        self.render = render
+
+        let link = CADisplayLink(target: DisplayLinkTarget { [weak self] in self?.tick() },
+                                 selector: #selector(DisplayLinkTarget.fire))
+        link.preferredFrameRateRange = CAFrameRateRange(minimum: 1, maximum: maxFramesPerSecond,
+                                                        preferred: maxFramesPerSecond)
+        link.isPaused = true
+        link.add(to: .main, forMode: .common)
+        displayLink = link
+    }
+
+    // MARK: - Producer
+
+    /// Replace the pending history; earlier histories not yet drawn are dropped
+    nonisolated func submit(_ history: [[Float]]) {
+        let shouldResume = pending.withLock { state -> Bool in
+            state.history = history
+            defer { state.isRunning = true }
+            return !state.isRunning
+        }
+        guard shouldResume else { return }
+        Task { @MainActor [weak self] in
+            self?.displayLink?.isPaused = false
+        }
+    }
+
+    // MARK: - Display Link
+
+    private func tick() {
+        let history = pending.withLock { state -> [[Float]]? in
+            defer { state.history = nil }
+            if state.history == nil {
+                state.isRunning = false
+            }
+            return state.history
+        }
+        guard let history = history else {
+            displayLink?.isPaused = true
+            return
+        }
+        render(history)
+        renderedCount += 1
+    }
+
+    // MARK: - Cleanup
+
+    /// Stop the display link; pending updates are discarded
+    func invalidate() {
+        displayLink?.invalidate()
+        displayLink = nil
+        pending.withLock { $0 = Pending() }
+    }
+}
+
+/// CADisplayLink retains its target, so display-link owners hand it this trampoline instead of themselves
+final class DisplayLinkTarget: NSObject {
+    private let action: @MainActor () -> Void
+
+    init(_ action: @escaping @MainActor () -> Void) {
+        self.action = action
+    }
+
+    @MainActor @objc func fire() {
+        action()
+    }
+}
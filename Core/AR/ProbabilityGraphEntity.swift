@@ -34,6 +34,7 @@ class ProbabilityGraphEntity: Entity {
     private let faceLostHysteresis: TimeInterval = 0.3  // 300ms before hiding
 
     private var currentMaterial: UnlitMaterial?
+    private var drawableTexture: TextureResource?  // Fed by a GPU drawable queue, survives plane recreation
 
     // MARK: - Initialization
 
@@ -61,6 +62,9 @@ class ProbabilityGraphEntity: Entity {
         // Create default material (will be updated with texture later)
         var material = UnlitMaterial()
         material.color = .init(tint: .white)
+        if let drawableTexture = drawableTexture {
+            material.color = .init(texture: .init(drawableTexture))
+        }
         currentMaterial = material
 
         // Create model entity
@@ -95,6 +99,28 @@ class ProbabilityGraphEntity: Entity {
         }
     }
 
+    /// Show the frames of a GPU drawable queue on the surface (see `MetalGraphRenderer`)
+    /// - Each presented drawable appears without a CPU copy; `updateTexture(_:)` is not needed
+    func attach(drawableQueue: TextureResource.DrawableQueue) {
+        guard let placeholder = makePlaceholderImage() else {
+            Log.error("[GraphEntity] Failed to create placeholder image")
+            return
+        }
+
+        do {
+            let textureResource = try TextureResource.generate(from: placeholder, options: .init(semantic: .color))
+            textureResource.replace(withDrawables: drawableQueue)
+            drawableTexture = textureResource
+
+            guard var material = currentMaterial else { return }
+            material.color = .init(texture: .init(textureResource))
+            currentMaterial = material
+            planeEntity?.model?.materials = [material]
+        } catch {
+            Log.error("[GraphEntity] Failed to create drawable texture resource: \(error)")
+        }
+    }
+
     // MARK: - Position Update
 
     /// Update surface position and scale based on face transform
@@ -236,6 +262,14 @@ class ProbabilityGraphEntity: Entity {
 
 private let sharedCIContext = CIContext()
 
+/// 1x1 transparent image; a drawable queue replaces its contents
+private func makePlaceholderImage() -> CGImage? {
+    let context = CGContext(data: nil, width: 1, height: 1, bitsPerComponent: 8, bytesPerRow: 4,
+                            space: CGColorSpaceCreateDeviceRGB(),
+                            bitmapInfo: CGImageAlphaInfo.premultipliedFirst.rawValue | CGBitmapInfo.byteOrder32Little.rawValue)
+    return context?.makeImage()
+}
+
 private func makeCGImage(from texture: MTLTexture) -> CGImage? {
     guard let ciImage = CIImage(mtlTexture: texture, options: nil) else {
         return nil
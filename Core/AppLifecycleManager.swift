@@ -23,6 +23,9 @@ class AppLifecycleManager: ObservableObject {
     /// Whether all pipelines should be paused (settings open or app backgrounded)
     @Published var shouldPausePipelines: Bool = false
 
+    /// Current device thermal state; the predictor lowers its inference rate as it rises
+    @Published var thermalState: ProcessInfo.ThermalState = ProcessInfo.processInfo.thermalState
+
     // MARK: - Private Properties
 
     private var cancellables = Set<AnyCancellable>()
@@ -70,6 +73,13 @@ class AppLifecycleManager: ObservableObject {
             name: UIApplication.willEnterForegroundNotification,
             object: nil
         )
+
+        NotificationCenter.default.addObserver(
+            self,
+            selector: #selector(thermalStateDidChange),
+            name: ProcessInfo.thermalStateDidChangeNotification,
+            object: nil
+        )
     }
 
     private func setupStateObservers() {
@@ -104,6 +114,7 @@ class AppLifecycleManager: ObservableObject {
     /// Register the FER predictor for lifecycle management
     func register(predictor: FERPredictorProtocol) {
         self.predictor = predictor
+        predictor.thermalStateDidChange(thermalState)
         Log.debug("[AppLifecycle] Predictor registered")
     }
 
@@ -159,6 +170,16 @@ class AppLifecycleManager: ObservableObject {
         }
     }
 
+    @objc private func thermalStateDidChange(_ notification: Notification) {
+        Task { @MainActor in
+            let state = ProcessInfo.processInfo.thermalState
+            guard state != thermalState else { return }
+            thermalState = state
+            predictor?.thermalStateDidChange(state)
+            Log.info("[AppLifecycle] Thermal state changed: \(state.rawValue)")
+        }
+    }
+
     // MARK: - Cleanup
 
     deinit {
@@ -178,4 +199,5 @@ protocol PipelineCoordinatorProtocol: AnyObject {
 protocol FERPredictorProtocol: AnyObject {
     func pause()
     func resume()
+    func thermalStateDidChange(_ state: ProcessInfo.ThermalState)
 }
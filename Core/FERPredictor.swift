@@ -6,93 +6,266 @@ import simd
 import CoreImage
 
 // MARK: - FER Predictor using Core ML
+/// Runs inference on its own serial queue: camera pipelines hand frames over from their
+/// processing queues and results reach SwiftUI through `publisher`, so neither inference
+/// nor per-frame work ever runs on the main thread
+/// - Everything but the published properties and `deliveredHistoryVersion` is touched only
+///   on `inferenceQueue`; the public methods queue their work there
 class FERPredictor: ObservableObject, FERPredictorProtocol {
+    private let inferenceQueue = DispatchQueue(label: "com.fer.inference", qos: .userInitiated)
+    private let backlog = FrameBacklog()  // Frames waiting for `inferenceQueue`
+
     private var model: VNCoreMLModel?
     private var request: VNCoreMLRequest?
+    private var batchPredictor: FaceBatchPredictor?
+    // Set only by `publisher`'s display link, at most once per refresh
     @Published var faceOutputs: [FacePrediction] = []
     @Published var probabilityHistory: [[Float]] = []
+    @Published var detectedFaces: [DetectedFace] = []
+
+    // Inference-side history; the UI gets copies through `publisher`
+    private var history: [[Float]] = []
+    private var historyVersion = 0
+    private var deliveredHistoryVersion = 0
+    private let publisher = PredictionPublisher(maxFramesPerSecond: 15)
+    private let telemetry = PipelineTelemetry.shared
 
-    private var smoothers: [Int: TemporalSmoother] = [:]
+    private let smootherPool: SmootherPool
     private var currentSettings: InferenceSettings
     private var currentModelType: MLModelType
     private let historyLimit = 75  // 5 seconds at 15fps
+    private let maxTrackedFaces = 4
     private var isPaused: Bool = false
 
+    // Skips inference while the largest face's expression holds, the device heats up or frames queue up
+    private let rateController = InferenceRateController()
+    private var followedTrackID = 0
+    private var heldOutputs: [Int: (trackID: Int, probabilities: [Float])] = [:]  // Last smoothed output per slot
+    // Model output of the current frame, one row per tracked face, decoded in place so
+    // reading the model's output allocates nothing
+    private var rawProbabilities: [[Float]] = []
+    private let rateReportInterval = 300  // Frames between rate log lines
+
+    // Raw and smoothed output of every inferred face, when launched with FER_RECORD_SESSION
+    private let sessionRecorder = SessionRecorder.fromEnvironment()
+    private var frameIndex = 0
+
     // Metal converter for high-performance grayscale conversion
     private let metalConverter = MetalGrayscaleConverter()
 
     init(settings: InferenceSettings) {
         self.currentSettings = settings
         self.currentModelType = settings.selectedModel
-        loadModel(settings.selectedModel)
+        self.smootherPool = SmootherPool(capacity: maxTrackedFaces, settings: settings)
+        self.rawProbabilities = (0..<maxTrackedFaces).map { _ in [Float](repeating: 0, count: emotionClasses.count) }
+        // Every model is loaded and warmed once in the background; switching is then a swap
+        ModelCache.shared.warmUp(first: settings.selectedModel)
+        onInferenceQueue { $0.loadModel(settings.selectedModel) }
         update(settings: settings)
+        publisher.start { [weak self] snapshot in self?.apply(snapshot) }
     }
 
+    /// Takes effect on the inference queue, between two frames
     func update(settings: InferenceSettings) {
-        let modelChanged = currentSettings.selectedModel != settings.selectedModel
-        currentSettings = settings
+        onInferenceQueue { predictor in
+            let modelChanged = predictor.currentSettings.selectedModel != settings.selectedModel
+            predictor.currentSettings = settings
+
+            if modelChanged {
+                predictor.currentModelType = settings.selectedModel
+                predictor.loadModel(settings.selectedModel)
+                predictor.resetState()
+            }
 
-        if modelChanged {
-            currentModelType = settings.selectedModel
-            loadModel(settings.selectedModel)
-            reset()
+            // Reset smoothers with new settings for each tracked face
+            predictor.smootherPool.reset(settings: settings)
         }
+    }
 
-        // Reset smoothers with new settings for each active face
-        smoothers = smoothers.mapValues { _ in TemporalSmoother(settings: settings) }
+    private func onInferenceQueue(_ body: @escaping (FERPredictor) -> Void) {
+        inferenceQueue.async { [weak self] in
+            guard let self = self else { return }
+            body(self)
+        }
     }
-    
+
+    /// Swaps in the cached model, or loads it in the background (frames are skipped until then)
     private func loadModel(_ modelType: MLModelType) {
-        let modelName = modelType.rawValue
-        // Try to load the model from the app bundle
-        guard let modelURL = Bundle.main.url(forResource: modelName, withExtension: "mlmodelc") ??
-                             Bundle.main.url(forResource: modelName, withExtension: "mlpackage") else {
-            print("Model '\(modelName)' not found in bundle")
+        if let loaded = ModelCache.shared.cached(modelType) {
+            activate(loaded)
             return
         }
+        model = nil
+        request = nil
+        batchPredictor = nil
+        ModelCache.shared.load(modelType) { [weak self] loaded in
+            guard let loaded = loaded else { return }
+            self?.onInferenceQueue { predictor in
+                guard predictor.currentModelType == modelType else { return }
+                predictor.activate(loaded)
+            }
+        }
+    }
 
-        do {
-            let compiledURL: URL
-            if modelURL.pathExtension == "mlpackage" || modelURL.pathExtension == "mlmodel" {
-                compiledURL = try MLModel.compileModel(at: modelURL)
+    private func activate(_ loaded: ModelCache.LoadedModel) {
+        model = loaded.visionModel
+        request = loaded.request
+        batchPredictor = loaded.batchPredictor
+        Log.info("[FERPredictor] Model '\(loaded.type.displayName)' active")
+    }
+    
+    /// Queue one camera frame for inference; called on a pipeline's processing queue
+    /// - Frames that arrive while an inference runs wait behind it, and the rate controller
+    ///   skips those that find frames queued behind them, so a slow model cannot build latency
+    func predict(pixelBuffer: CVPixelBuffer, faces: [DetectedFace], orientation: CGImagePropertyOrientation = .up) {
+        backlog.enter()
+        inferenceQueue.async { [weak self] in
+            guard let self = self else { return }
+            self.backlog.leave()
+            self.infer(pixelBuffer: pixelBuffer, faces: faces, orientation: orientation)
+        }
+    }
+
+    private func infer(pixelBuffer: CVPixelBuffer, faces: [DetectedFace], orientation: CGImagePropertyOrientation) {
+        // Skip prediction if paused
+        guard !isPaused else { return }
+
+        // The faces still reach the UI while the model loads
+        guard let request = request, !faces.isEmpty else {
+            publish(PredictionSnapshot(faces: [], detectedFaces: faces, history: history, historyVersion: historyVersion))
+            return
+        }
+
+        frameIndex += 1
+
+        // Largest faces first; each keeps its smoother through its IoU track ID
+        let trackedFaces = Array(faces.sorted { $0.boundingBox.area > $1.boundingBox.area }.prefix(maxTrackedFaces))
+        let slots = smootherPool.assign(trackedFaces.map(\.boundingBox))
+
+        let rois = trackedFaces.map { inferenceROI(for: $0.boundingBox) }
+
+        // The rate follows the largest face; a new face starts back at the full rate
+        let primaryTrackID = slots.first.flatMap { $0 }.map { smootherPool.trackID(at: $0) } ?? 0
+        if primaryTrackID != followedTrackID {
+            rateController.resetOutput()
+            followedTrackID = primaryTrackID
+        }
+        let queued = backlog.pending
+        telemetry.recordDepth(.inference, queued)
+        let shouldInfer = rateController.shouldInfer(backlog: queued)
+        if rateController.stats.frames % rateReportInterval == 0 {
+            Log.debug("[FERPredictor] Inference rate: \(rateController.stats)")
+            Log.debug("[FERPredictor] Telemetry, \(telemetry.snapshot())")
+        }
+        guard shouldInfer else {
+            Trace.event("skippedInference")
+            telemetry.recordDrop(.inference)
+            publishHeldPredictions(for: trackedFaces, slots: slots, rois: rois, detected: faces)
+            return
+        }
+
+        // One batched model launch for all faces; per-face Vision requests if batching is unavailable.
+        // Face i's probabilities land in rawProbabilities[i]; `decoded[i]` tells whether they did
+        let decoded: [Bool] = Trace.interval("inference") {
+            if let batchPredictor = batchPredictor, batchPredictor.usesTensorInput,
+               let outputs = batchPredictor.predict(pixelBuffer: pixelBuffer, orientation: orientation, rois: rois) {
+                // Fused Metal crop + grayscale + resize + normalize straight from the camera frame
+                return outputs.enumerated().map { extractProbabilities(from: $1, into: $0) }
+            } else if let batchPredictor = batchPredictor, !batchPredictor.usesTensorInput,
+                      let outputs = batchPredictor.predict(image: grayscaleImage(from: pixelBuffer),
+                                                           orientation: orientation, rois: rois) {
+                return outputs.enumerated().map { extractProbabilities(from: $1, into: $0) }
             } else {
-                compiledURL = modelURL
+                if batchPredictor != nil {
+                    Log.warn("[FERPredictor] Batch prediction failed; falling back to per-face Vision requests")
+                }
+                // Grayscale conversion happens once per frame and is shared by every face
+                let grayscale = grayscaleImage(from: pixelBuffer)
+                let handler = VNImageRequestHandler(ciImage: grayscale, orientation: orientation, options: [:])
+                return rois.enumerated().map { index, roi in
+                    request.regionOfInterest = roi
+                    do {
+                        try handler.perform([request])
+                    } catch {
+                        print("Prediction error: \(error)")
+                        return false
+                    }
+                    return extractProbabilities(from: request, into: index)
+                }
             }
+        }
 
-            // Configure for ANE usage
-            let config = MLModelConfiguration()
-            config.computeUnits = .all // Explicitly allow ANE, GPU, and CPU
+        if let captureTime = trackedFaces.first?.captureTime {
+            telemetry.recordInference(captureTime: captureTime)
+        }
+
+        var predictions: [FacePrediction] = []
+        for (index, isDecoded) in decoded.enumerated() {
+            guard isDecoded, let slot = slots[index] else { continue }
+            let raw = rawProbabilities[index]
+            let smoothed = Trace.interval("smoothing") { smootherPool.smoother(at: slot).smooth(raw) }
+            let trackID = smootherPool.trackID(at: slot)
+            heldOutputs[slot] = (trackID, smoothed)
+            sessionRecorder?.append(frameIndex: frameIndex, trackID: trackID,
+                                    boundingBox: trackedFaces[index].boundingBox, raw: raw, smoothed: smoothed)
+            if index == 0 {
+                rateController.observe(smoothed)
+            }
+            guard let prediction = makePrediction(for: trackedFaces[index], roi: rois[index], probabilities: smoothed,
+                                                  trackID: trackID) else { continue }
+            predictions.append(prediction)
+        }
+        guard let primary = predictions.first else { return }
 
-            let mlModel = try MLModel(contentsOf: compiledURL, configuration: config)
-            model = try VNCoreMLModel(for: mlModel)
+        history.append(primary.probabilities)
+        if history.count > historyLimit {
+            history.removeFirst()
+        }
+        historyVersion += 1
+        publish(PredictionSnapshot(faces: predictions, detectedFaces: faces, history: history, historyVersion: historyVersion))
+    }
 
-            let coreRequest = VNCoreMLRequest(model: model!)
-            coreRequest.imageCropAndScaleOption = .scaleFill
-            request = coreRequest
+    /// Frames the rate controller skips keep each face's last smoothed output at its new position
+    private func publishHeldPredictions(for faces: [DetectedFace], slots: [Int?], rois: [CGRect], detected: [DetectedFace]) {
+        var predictions: [FacePrediction] = []
+        for (index, face) in faces.enumerated() {
+            guard let slot = slots[index],
+                  let held = heldOutputs[slot], held.trackID == smootherPool.trackID(at: slot),
+                  let prediction = makePrediction(for: face, roi: rois[index], probabilities: held.probabilities,
+                                                  trackID: held.trackID) else { continue }
+            predictions.append(prediction)
+        }
+        publish(PredictionSnapshot(faces: predictions, detectedFaces: detected, history: history, historyVersion: historyVersion))
+    }
 
-            print("Model '\(modelType.displayName)' loaded successfully")
-        } catch {
-            print("Error loading model '\(modelName)': \(error)")
+    /// Snapshots replaced before the display link took them count as display-stage drops
+    private func publish(_ snapshot: PredictionSnapshot) {
+        if publisher.publish(snapshot) {
+            telemetry.recordDrop(.display)
         }
     }
-    
-    func predict(pixelBuffer: CVPixelBuffer, faces: [DetectedFace], orientation: CGImagePropertyOrientation = .up) {
-        // Skip prediction if paused
-        guard !isPaused else { return }
 
-        guard let request = request else { return }
-        guard let targetFace = faces.max(by: { $0.boundingBox.area < $1.boundingBox.area }) else {
-            DispatchQueue.main.async {
-                self.faceOutputs = []
-            }
-            return
+    /// Display-link side of `publisher`: touches the published properties only when they change,
+    /// so SwiftUI invalidates at most once per refresh and not at all while nothing changes
+    private func apply(_ snapshot: PredictionSnapshot) {
+        // Glass-to-glass ends when this refresh reaches the screen; frames without faces carry no capture time
+        if let captureTime = snapshot.faces.first?.captureTime {
+            telemetry.recordDisplay(captureTime: captureTime, displayTime: publisher.targetTimestamp)
         }
-        
-        ensureSmoothers(count: 1)
-        
-        // Clamp bounding box to [0, 1] to avoid Vision errors
-        let bbox = targetFace.boundingBox
+        if snapshot.historyVersion != deliveredHistoryVersion {
+            deliveredHistoryVersion = snapshot.historyVersion
+            probabilityHistory = snapshot.history
+        }
+        if !(snapshot.faces.isEmpty && faceOutputs.isEmpty) {
+            faceOutputs = snapshot.faces
+        }
+        if !(snapshot.detectedFaces.isEmpty && detectedFaces.isEmpty) {
+            detectedFaces = snapshot.detectedFaces
+        }
+    }
 
+    /// Square, expanded and clamped Vision region of interest for a face bounding box
+    private func inferenceROI(for bbox: CGRect) -> CGRect {
         // CRITICAL FIX: Make bbox square FIRST, THEN expand to ensure equal padding
         // Previous order (expand→square) caused unequal expansion on width vs height
 
@@ -141,127 +314,127 @@ class FERPredictor: ObservableObject, FERPredictorProtocol {
             )
         }
 
-        request.regionOfInterest = finalSquare
-        let appliedROI = finalSquare
+        return finalSquare
+    }
 
+    private func grayscaleImage(from pixelBuffer: CVPixelBuffer) -> CIImage {
         // Use Metal for high-performance grayscale conversion
         // This matches the C++ implementation's preprocessing step
-        var handler: VNImageRequestHandler
         if let converter = metalConverter,
            let grayBuffer = converter.convert(pixelBuffer: pixelBuffer) {
-            handler = VNImageRequestHandler(cvPixelBuffer: grayBuffer, orientation: orientation, options: [:])
-        } else {
-            // Fallback to CoreImage if Metal fails
-            let ciImage = CIImage(cvPixelBuffer: pixelBuffer)
-            let grayscale = ciImage.applyingFilter("CIPhotoEffectMono")
-            handler = VNImageRequestHandler(ciImage: grayscale, orientation: orientation, options: [:])
-        }
-
-        do {
-            try handler.perform([request])
-        } catch {
-            print("Prediction error: \(error)")
-            return
+            return CIImage(cvPixelBuffer: grayBuffer)
         }
+        // Fallback to CoreImage if Metal fails
+        return CIImage(cvPixelBuffer: pixelBuffer).applyingFilter("CIPhotoEffectMono")
+    }
 
-        guard let raw = extractProbabilities(from: request) else { return }
-        let smoothed = smoothers[0]?.smooth(raw) ?? raw
+    private func makePrediction(for face: DetectedFace, roi: CGRect, probabilities smoothed: [Float], trackID: Int) -> FacePrediction? {
+        guard let maxIdx = smoothed.indices.max(by: { smoothed[$0] < smoothed[$1] }) else { return nil }
 
-        guard let maxIdx = smoothed.indices.max(by: { smoothed[$0] < smoothed[$1] }) else { return }
-        
-        let prediction = FacePrediction(
-            boundingBox: targetFace.boundingBox,
-            inferenceROI: appliedROI,
-            depthMeters: targetFace.depthMeters,
+        return FacePrediction(
+            boundingBox: face.boundingBox,
+            inferenceROI: roi,
+            depthMeters: face.depthMeters,
             probabilities: smoothed,
             dominantEmotion: emotionClasses[maxIdx],
             dominantEmoji: emotionEmojis[maxIdx],
             confidence: smoothed[maxIdx],
-            yaw: targetFace.yaw,
-            pitch: targetFace.pitch,
-            roll: targetFace.roll,
-            worldPosition: targetFace.worldPosition,
-            transform: targetFace.transform,
-            blendShapes: targetFace.blendShapes
+            yaw: face.yaw,
+            pitch: face.pitch,
+            roll: face.roll,
+            worldPosition: face.worldPosition,
+            transform: face.transform,
+            blendShapes: face.blendShapes,
+            trackID: trackID,
+            captureTime: face.captureTime
         )
-
-        var updatedHistory = probabilityHistory
-        updatedHistory.append(smoothed)
-        if updatedHistory.count > historyLimit {
-            updatedHistory.removeFirst()
-        }
-
-        DispatchQueue.main.async {
-            self.probabilityHistory = updatedHistory
-            self.faceOutputs = [prediction]
-        }
     }
     
-    private func extractProbabilities(from request: VNCoreMLRequest) -> [Float]? {
+    /// Probabilities from a Vision request into `rawProbabilities[row]`; false if there are none
+    private func extractProbabilities(from request: VNCoreMLRequest, into row: Int) -> Bool {
+        guard row < rawProbabilities.count else { return false }
         if let results = request.results as? [VNCoreMLFeatureValueObservation],
            let first = results.first,
            let multiArray = first.featureValue.multiArrayValue {
             // Assume MultiArray output is logits (raw scores) -> apply softmax
-            let logits = extractProbabilities(from: multiArray)
-            guard logits.count == 7 else { return nil }
-            return softmax(logits)
+            return rawProbabilities[row].withUnsafeMutableBufferPointer { ModelOutput.softmax(multiArray, into: $0) }
         } else if let results = request.results as? [VNClassificationObservation] {
             // Classification observations are already probabilities (confidence)
-            return classificationToProbabilities(results)
+            storeProbabilities(results.map { ($0.identifier, $0.confidence) }, into: row)
+            return true
         }
-        return nil
+        return false
     }
-    
-    private func extractProbabilities(from multiArray: MLMultiArray) -> [Float] {
-        var result = [Float]()
-        for i in 0..<multiArray.count {
-            result.append(Float(truncating: multiArray[i]))
+
+    /// Probabilities from one batched prediction, read the same way as the Vision results
+    private func extractProbabilities(from output: MLFeatureProvider, into row: Int) -> Bool {
+        guard row < rawProbabilities.count else { return false }
+        for name in output.featureNames.sorted() {
+            guard let value = output.featureValue(for: name) else { continue }
+            if let multiArray = value.multiArrayValue {
+                // Assume MultiArray output is logits (raw scores) -> apply softmax
+                guard rawProbabilities[row].withUnsafeMutableBufferPointer({ ModelOutput.softmax(multiArray, into: $0) })
+                else { continue }
+                return true
+            }
+            if value.type == .dictionary {
+                // Class label -> probability, like VNClassificationObservation confidences
+                storeProbabilities(value.dictionaryValue.compactMap { label, probability in
+                    (label as? String).map { ($0, probability.floatValue) }
+                }, into: row)
+                return true
+            }
         }
-        return result
+        return false
     }
-    
-    private func classificationToProbabilities(_ observations: [VNClassificationObservation]) -> [Float] {
-        var probs = [Float](repeating: 0, count: 7)
-        for obs in observations {
-            if let idx = emotionClasses.firstIndex(of: obs.identifier.lowercased()) {
-                probs[idx] = obs.confidence
+
+    /// Class confidences by label into `rawProbabilities[row]`; classes without a label get 0
+    private func storeProbabilities(_ confidences: [(String, Float)], into row: Int) {
+        rawProbabilities[row].withUnsafeMutableBufferPointer { probs in
+            probs.update(repeating: 0)
+            for (label, confidence) in confidences {
+                if let idx = emotionClasses.firstIndex(of: label.lowercased()), idx < probs.count {
+                    probs[idx] = confidence
+                }
             }
         }
-        return probs
-    }
-    
-    private func softmax(_ logits: [Float]) -> [Float] {
-        let maxLogit = logits.max() ?? 0
-        let exps = logits.map { exp($0 - maxLogit) }
-        let sum = exps.reduce(0, +)
-        return exps.map { $0 / sum }
     }
     
     func reset() {
-        smoothers = [:]
+        onInferenceQueue { $0.resetState() }
     }
 
-    private func ensureSmoothers(count: Int) {
-        if smoothers.count != count {
-            var new: [Int: TemporalSmoother] = [:]
-            for idx in 0..<count {
-                new[idx] = TemporalSmoother(settings: currentSettings)
-            }
-            smoothers = new
-        }
+    private func resetState() {
+        smootherPool.reset()
+        heldOutputs.removeAll()
+        rateController.reset()
+        followedTrackID = 0
     }
 
     // MARK: - FERPredictorProtocol
 
     func pause() {
-        isPaused = true
+        publisher.isPaused = true
+        onInferenceQueue { predictor in
+            predictor.isPaused = true
+            predictor.sessionRecorder?.flush()
+            predictor.metalConverter?.outputPool.flush()
+        }
         Log.info("[FERPredictor] Paused")
     }
 
     func resume() {
-        isPaused = false
+        publisher.isPaused = false
+        onInferenceQueue { $0.isPaused = false }
         Log.info("[FERPredictor] Resumed")
     }
+
+    func thermalStateDidChange(_ state: ProcessInfo.ThermalState) {
+        onInferenceQueue { predictor in
+            predictor.rateController.thermalState = state
+            Log.info("[FERPredictor] Thermal state \(state.rawValue), at most one inference every \(predictor.rateController.interval) frames")
+        }
+    }
 }
 
 private extension CGRect {
@@ -288,6 +461,10 @@ struct FacePrediction: Identifiable {
     let transform: simd_float4x4?
     /// Face geometry blend shapes (for detailed expression tracking)
     let blendShapes: [String: Float]?
+    /// IoU track ID from the smoother pool (stable while the face stays in view)
+    let trackID: Int
+    /// Host time the camera captured the frame the face was detected in (from `DetectedFace`)
+    let captureTime: TimeInterval?
     
     init(
         boundingBox: CGRect,
@@ -302,7 +479,9 @@ struct FacePrediction: Identifiable {
         roll: Float?,
         worldPosition: SIMD3<Float>? = nil,
         transform: simd_float4x4? = nil,
-        blendShapes: [String: Float]? = nil
+        blendShapes: [String: Float]? = nil,
+        trackID: Int = 0,
+        captureTime: TimeInterval? = nil
     ) {
         self.boundingBox = boundingBox
         self.inferenceROI = inferenceROI
@@ -317,5 +496,7 @@ struct FacePrediction: Identifiable {
         self.worldPosition = worldPosition
         self.transform = transform
         self.blendShapes = blendShapes
+        self.trackID = trackID
+        self.captureTime = captureTime
     }
 }
@@ -0,0 +1,153 @@
+import Foundation
+import CoreML
+import CoreImage
+import CoreVideo
+import ImageIO
+
+// MARK: - Face Batch Predictor
+/// Runs every face crop of a frame through the model in one `MLModel.predictions(from:)` call
+/// (the Swift side of `example_/FaceBatch.h`).
+/// For an image input, crops are scaled to the model's input size straight into pixel buffers
+/// allocated once per slot. For a float32 multi-array input (`[.., C, H, W]`), the fused Metal
+/// kernel in `MetalFacePreprocessor` writes every face's tensor in one dispatch and CoreML reads
+/// them in place. Either way a frame with N faces costs one model launch instead of N Vision requests.
+/// Returns nil when the model has neither input kind, in which case the caller keeps using Vision.
+final class FaceBatchPredictor {
+    private let model: MLModel
+    private let inputName: String
+    private let inputSize: CGSize
+    private let inputBuffers: [CVPixelBuffer]
+    private let tensorPreprocessor: MetalFacePreprocessor?
+    private let tensorShape: [NSNumber]
+    private let context = CIContext(options: [.workingColorSpace: NSNull()])
+
+    let capacity: Int
+    /// Whether the model takes preprocessed tensors (use `predict(pixelBuffer:orientation:rois:)`)
+    var usesTensorInput: Bool { tensorPreprocessor != nil }
+
+    init?(model: MLModel, capacity: Int) {
+        let inputs = model.modelDescription.inputDescriptionsByName
+        if let input = inputs.first(where: { $0.value.type == .image }),
+           let constraint = input.value.imageConstraint {
+            let attrs = [
+                kCVPixelBufferMetalCompatibilityKey: true,
+                kCVPixelBufferIOSurfacePropertiesKey: [:]
+            ] as CFDictionary
+            var buffers: [CVPixelBuffer] = []
+            for _ in 0..<max(1, capacity) {
+                var buffer: CVPixelBuffer?
+                let status = CVPixelBufferCreate(kCFAllocatorDefault, constraint.pixelsWide, constraint.pixelsHigh,
+                                                 constraint.pixelFormatType, attrs, &buffer)
+                guard status == kCVReturnSuccess, let buffer = buffer else {
+                    Log.error("[FaceBatchPredictor] Failed to allocate input buffer (status \(status))")
+                    return nil
+                }
+                buffers.append(buffer)
+            }
+
+            self.inputName = input.key
+            self.inputSize = CGSize(width: constraint.pixelsWide, height: constraint.pixelsHigh)
+            self.inputBuffers = buffers
+            self.tensorPreprocessor = nil
+            self.tensorShape = []
+            self.capacity = buffers.count
+        } else if let input = inputs.first(where: { $0.value.type == .multiArray }),
+                  let constraint = input.value.multiArrayConstraint,
+                  constraint.dataType == .float32,
+                  let preprocessor = FaceBatchPredictor.makeTensorPreprocessor(shape: constraint.shape, capacity: capacity) {
+            self.inputName = input.key
+            self.inputSize = CGSize(width: Int(preprocessor.width), height: Int(preprocessor.height))
+            self.inputBuffers = []
+            self.tensorPreprocessor = preprocessor
+            self.tensorShape = constraint.shape
+            self.capacity = preprocessor.maxFaces
+        } else {
+            Log.warn("[FaceBatchPredictor] Model has no image or float32 tensor input; batching disabled")
+            return nil
+        }
+        self.model = model
+    }
+
+    /// Metal preprocessor for a `[1.., C, H, W]` tensor input, or nil for any other shape
+    private static func makeTensorPreprocessor(shape: [NSNumber], capacity: Int) -> MetalFacePreprocessor? {
+        let dims = shape.map(\.intValue)
+        guard dims.count >= 2 else { return nil }
+        let height = dims[dims.count - 2]
+        let width = dims[dims.count - 1]
+        let channels = dims.count >= 3 ? dims[dims.count - 3] : 1
+        guard dims.dropLast(3).allSatisfy({ $0 == 1 }), channels == 1 || channels == 3 else { return nil }
+        return MetalFacePreprocessor(maxFaces: capacity, width: width, height: height, channels: channels)
+    }
+
+    /// Predict all `rois` (normalized, lower-left origin like Vision) of `image` in one batch.
+    /// Only the first `capacity` ROIs are used; outputs are in ROI order.
+    func predict(image: CIImage, orientation: CGImagePropertyOrientation, rois: [CGRect]) -> [MLFeatureProvider]? {
+        guard !usesTensorInput else { return nil }
+        let upright = image.oriented(orientation)
+        let extent = upright.extent
+        var inputs: [MLFeatureProvider] = []
+        inputs.reserveCapacity(min(rois.count, capacity))
+
+        for (roi, buffer) in zip(rois, inputBuffers) {
+            // Same crop Vision applies for regionOfInterest + .scaleFill
+            let crop = CGRect(x: extent.minX + roi.minX * extent.width,
+                              y: extent.minY + roi.minY * extent.height,
+                              width: roi.width * extent.width,
+                              height: roi.height * extent.height)
+            guard crop.width > 0, crop.height > 0 else { return nil }
+
+            let scaled = upright.cropped(to: crop)
+                .transformed(by: CGAffineTransform(translationX: -crop.minX, y: -crop.minY))
+                .transformed(by: CGAffineTransform(scaleX: inputSize.width / crop.width,
+                                                   y: inputSize.height / crop.height))
+            context.render(scaled, to: buffer)
+
+            guard let provider = try? MLDictionaryFeatureProvider(
+                dictionary: [inputName: MLFeatureValue(pixelBuffer: buffer)]) else { return nil }
+            inputs.append(provider)
+        }
+        return run(inputs)
+    }
+
+    /// Predict all `rois` straight from the BGRA camera frame through the fused Metal kernel.
+    /// Only for tensor-input models; the kernel applies `orientation` when it samples the buffer,
+    /// so `rois` are in the same upright frame Vision detected them in.
+    func predict(pixelBuffer: CVPixelBuffer, orientation: CGImagePropertyOrientation, rois: [CGRect]) -> [MLFeatureProvider]? {
+        guard let preprocessor = tensorPreprocessor,
+              let count = preprocessor.preprocess(pixelBuffer: pixelBuffer, orientation: orientation, rois: rois) else {
+            return nil
+        }
+
+        let dims = tensorShape.map(\.intValue)
+        var strides = [Int](repeating: 1, count: dims.count)
+        for axis in stride(from: dims.count - 2, through: 0, by: -1) {
+            strides[axis] = strides[axis + 1] * dims[axis + 1]
+        }
+        let base = preprocessor.output.contents().assumingMemoryBound(to: Float.self)
+
+        var inputs: [MLFeatureProvider] = []
+        inputs.reserveCapacity(count)
+        for face in 0..<count {
+            // Wraps this face's slice of the Metal buffer; no copy
+            guard let tensor = try? MLMultiArray(dataPointer: base + face * preprocessor.faceStride,
+                                                 shape: tensorShape, dataType: .float32,
+                                                 strides: strides.map { NSNumber(value: $0) }),
+                  let provider = try? MLDictionaryFeatureProvider(
+                      dictionary: [inputName: MLFeatureValue(multiArray: tensor)]) else { return nil }
+            inputs.append(provider)
+        }
+        return run(inputs)
+    }
+
+    private func run(_ inputs: [MLFeatureProvider]) -> [MLFeatureProvider]? {
+        guard !inputs.isEmpty else { return [] }
+
+        do {
+            let outputs = try model.predictions(from: MLArrayBatchProvider(array: inputs), options: MLPredictionOptions())
+            return (0..<outputs.count).map { outputs.features(at: $0) }
+        } catch {
+            Log.error("[FaceBatchPredictor] Batch prediction failed: \(error)")
+            return nil
+        }
+    }
+}
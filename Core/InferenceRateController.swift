@@ -0,0 +1,148 @@
+import Foundation
+import os
+
+/// Decides per frame whether to run inference (mirrors `example_/InferenceRateController.h`)
+/// - Stability: the interval doubles (up to `maxInterval` frames) after `stableObservationsToSlow`
+///   inferences whose smoothed output moved less than `stableChange`, and drops back to every
+///   frame as soon as one moves by `changeThreshold`
+/// - Thermal: at least 1 / 2 / 4 / `maxInterval` frames per inference for nominal / fair /
+///   serious / critical
+/// - Backlog: frames that arrive with more than `backlogLimit` frames queued behind them are skipped
+final class InferenceRateController {
+
+    // MARK: - Types
+
+    struct Settings {
+        var maxInterval = 8
+        var stableChange: Float = 0.02
+        var changeThreshold: Float = 0.08
+        var stableObservationsToSlow = 10
+        var backlogLimit = 0
+    }
+
+    struct Stats: CustomStringConvertible {
+        var frames = 0
+        var inferences = 0
+        /// Skipped to hold the interval (stable output or thermal state)
+        var skippedRate = 0
+        /// Skipped because frames were queued behind this one
+        var skippedBacklog = 0
+        var seconds: TimeInterval = 0
+
+        var skipped: Int { skippedRate + skippedBacklog }
+        var inferenceRate: Double { seconds > 0 ? Double(inferences) / seconds : 0 }
+        var frameRate: Double { seconds > 0 ? Double(frames) / seconds : 0 }
+
+        var description: String {
+            String(format: "%d/%d frames inferred (%.1f Hz of %.1f Hz), skipped %d by rate, %d backlogged",
+                   inferences, frames, inferenceRate, frameRate, skippedRate, skippedBacklog)
+        }
+    }
+
+    // MARK: - Properties
+
+    let settings: Settings
+    var thermalState: ProcessInfo.ThermalState = .nominal
+
+    private var stabilityInterval = 1
+    private var stableRun = 0
+    private var framesSinceInference = 0
+    private var lastOutput: [Float]?
+    private var counters = Stats()
+    private var start = Date()
+
+    var stats: Stats {
+        var stats = counters
+        stats.seconds = Date().timeIntervalSince(start)
+        return stats
+    }
+
+    /// Frames between inferences right now, ignoring backlog
+    var interval: Int {
+        min(max(stabilityInterval, thermalInterval, 1), max(settings.maxInterval, 1))
+    }
+
+    private var thermalInterval: Int {
+        switch thermalState {
+        case .nominal: return 1
+        case .fair: return 2
+        case .serious: return 4
+        case .critical: return settings.maxInterval
+        @unknown default: return 1
+        }
+    }
+
+    // MARK: - Initialization
+
+    init(settings: Settings = Settings()) {
+        self.settings = settings
+    }
+
+    // MARK: - Control
+
+    /// Call once per frame; true when this frame should go through the model
+    func shouldInfer(backlog: Int = 0) -> Bool {
+        counters.frames += 1
+        framesSinceInference += 1
+        if backlog > settings.backlogLimit {
+            counters.skippedBacklog += 1
+            return false
+        }
+        if framesSinceInference < (lastOutput == nil ? thermalInterval : interval) {
+            counters.skippedRate += 1
+            return false
+        }
+        framesSinceInference = 0
+        counters.inferences += 1
+        return true
+    }
+
+    /// Feed the smoothed output of the followed face after each inference
+    func observe(_ output: [Float]) {
+        var change = settings.changeThreshold
+        if let last = lastOutput, last.count == output.count {
+            change = zip(output, last).reduce(0) { max($0, abs($1.0 - $1.1)) }
+        }
+        lastOutput = output
+
+        if change >= settings.changeThreshold {
+            stabilityInterval = 1
+            stableRun = 0
+        } else if change >= settings.stableChange {
+            stableRun = 0
+        } else {
+            stableRun += 1
+            if stableRun >= settings.stableObservationsToSlow {
+                stabilityInterval = min(stabilityInterval * 2, max(settings.maxInterval, 1))
+                stableRun = 0
+            }
+        }
+    }
+
+    /// Forget the followed output (another face is followed); back to the thermal limit
+    func resetOutput() {
+        lastOutput = nil
+        stabilityInterval = 1
+        stableRun = 0
+    }
+
+    /// Also clears the statistics
+    func reset() {
+        resetOutput()
+        framesSinceInference = 0
+        counters = Stats()
+        start = Date()
+    }
+}
+
+/// Frames handed to a queue but not yet taken off it
+/// - Call `enter()` before `queue.async` and `leave()` first thing inside the block, so
+///   `pending` seen from that block is the number of frames queued behind it
+final class FrameBacklog: @unchecked Sendable {
+    private let count = OSAllocatedUnfairLock(initialState: 0)
+
+    var pending: Int { count.withLock { $0 } }
+
+    func enter() { count.withLock { $0 += 1 } }
+    func leave() { count.withLock { $0 = max($0 - 1, 0) } }
+}
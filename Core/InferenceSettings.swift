@@ -49,6 +49,7 @@ struct InferenceSettings: Codable, RawRepresentable, Equatable {
     let graphSurfaceMaxSize: Float
     let enableScreenRecording: Bool  // Allow screen recording in AR mode
     let enableLiDAR: Bool  // Enable LiDAR depth estimation (back camera only)
+    let showTelemetry: Bool  // Latency / drop / queue depth overlay
 
     init(
         ringBufferSize: Int = 60,
@@ -67,7 +68,8 @@ struct InferenceSettings: Codable, RawRepresentable, Equatable {
         graphSurfaceMinSize: Float = 0.2,
         graphSurfaceMaxSize: Float = 0.8,
         enableScreenRecording: Bool = false,
-        enableLiDAR: Bool = true
+        enableLiDAR: Bool = true,
+        showTelemetry: Bool = false
     ) {
         self.ringBufferSize = ringBufferSize
         self.emaAlpha = emaAlpha
@@ -86,6 +88,39 @@ struct InferenceSettings: Codable, RawRepresentable, Equatable {
         self.graphSurfaceMaxSize = graphSurfaceMaxSize
         self.enableScreenRecording = enableScreenRecording
         self.enableLiDAR = enableLiDAR
+        self.showTelemetry = showTelemetry
+    }
+
+    private enum CodingKeys: String, CodingKey {
+        case ringBufferSize, emaAlpha, neutralBoost, framesForAverage, faceExpansionRatio
+        case showFaceRect, selectedModel, enableARGraph, graphSurfaceOffsetMeters, graphSurfaceSide
+        case graphSurfaceBaseWidth, graphSurfaceBaseHeight, graphSurfaceScalingFactor
+        case graphSurfaceMinSize, graphSurfaceMaxSize, enableScreenRecording, enableLiDAR
+        case showTelemetry
+    }
+
+    /// Keys added after settings were first persisted decode with their default,
+    /// so settings saved by an older build still load instead of resetting.
+    init(from decoder: Decoder) throws {
+        let container = try decoder.container(keyedBy: CodingKeys.self)
+        ringBufferSize = try container.decode(Int.self, forKey: .ringBufferSize)
+        emaAlpha = try container.decode(Double.self, forKey: .emaAlpha)
+        neutralBoost = try container.decode(Double.self, forKey: .neutralBoost)
+        framesForAverage = try container.decode(Int.self, forKey: .framesForAverage)
+        faceExpansionRatio = try container.decode(Double.self, forKey: .faceExpansionRatio)
+        showFaceRect = try container.decode(Bool.self, forKey: .showFaceRect)
+        selectedModel = try container.decode(MLModelType.self, forKey: .selectedModel)
+        enableARGraph = try container.decode(Bool.self, forKey: .enableARGraph)
+        graphSurfaceOffsetMeters = try container.decode(Float.self, forKey: .graphSurfaceOffsetMeters)
+        graphSurfaceSide = try container.decode(GraphSide.self, forKey: .graphSurfaceSide)
+        graphSurfaceBaseWidth = try container.decode(Float.self, forKey: .graphSurfaceBaseWidth)
+        graphSurfaceBaseHeight = try container.decode(Float.self, forKey: .graphSurfaceBaseHeight)
+        graphSurfaceScalingFactor = try container.decode(Float.self, forKey: .graphSurfaceScalingFactor)
+        graphSurfaceMinSize = try container.decode(Float.self, forKey: .graphSurfaceMinSize)
+        graphSurfaceMaxSize = try container.decode(Float.self, forKey: .graphSurfaceMaxSize)
+        enableScreenRecording = try container.decode(Bool.self, forKey: .enableScreenRecording)
+        enableLiDAR = try container.decode(Bool.self, forKey: .enableLiDAR)
+        showTelemetry = try container.decodeIfPresent(Bool.self, forKey: .showTelemetry) ?? false
     }
 
     init?(rawValue: Data) {
@@ -114,7 +149,8 @@ struct InferenceSettings: Codable, RawRepresentable, Equatable {
         lhs.graphSurfaceMinSize == rhs.graphSurfaceMinSize &&
         lhs.graphSurfaceMaxSize == rhs.graphSurfaceMaxSize &&
         lhs.enableScreenRecording == rhs.enableScreenRecording &&
-        lhs.enableLiDAR == rhs.enableLiDAR
+        lhs.enableLiDAR == rhs.enableLiDAR &&
+        lhs.showTelemetry == rhs.showTelemetry
     }
 
     // Convenience copy-with helper to avoid reconstructing manually
@@ -135,7 +171,8 @@ struct InferenceSettings: Codable, RawRepresentable, Equatable {
         graphSurfaceMinSize: Float? = nil,
         graphSurfaceMaxSize: Float? = nil,
         enableScreenRecording: Bool? = nil,
-        enableLiDAR: Bool? = nil
+        enableLiDAR: Bool? = nil,
+        showTelemetry: Bool? = nil
     ) -> InferenceSettings {
         InferenceSettings(
             ringBufferSize: ringBufferSize ?? self.ringBufferSize,
@@ -154,7 +191,8 @@ struct InferenceSettings: Codable, RawRepresentable, Equatable {
             graphSurfaceMinSize: graphSurfaceMinSize ?? self.graphSurfaceMinSize,
             graphSurfaceMaxSize: graphSurfaceMaxSize ?? self.graphSurfaceMaxSize,
             enableScreenRecording: enableScreenRecording ?? self.enableScreenRecording,
-            enableLiDAR: enableLiDAR ?? self.enableLiDAR
+            enableLiDAR: enableLiDAR ?? self.enableLiDAR,
+            showTelemetry: showTelemetry ?? self.showTelemetry
         )
     }
 }
@@ -5,8 +5,9 @@ import os.log
 /// - Uses Apple's `os.Logger` for system-level logging (visible in Console.app)
 /// - Uses `LogEngine` for console output with file/function/line info
 struct Log {
-    private static let subsystem = Bundle.main.bundleIdentifier ?? "com.app.fer"
-    private static let logger = Logger(subsystem: subsystem, category: "FER")
+    static let subsystem = Bundle.main.bundleIdentifier ?? "com.app.fer"
+    static let category = "FER"
+    private static let logger = Logger(subsystem: subsystem, category: category)
     
     /// Enable or disable console logging at runtime
     static func enable(_ flag: Bool) {
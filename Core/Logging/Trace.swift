@@ -0,0 +1,31 @@
+import Foundation
+import os
+
+/// Hot-path stage timing as os_signpost intervals
+/// - Same subsystem and category as `Log`, so Instruments (os_signpost / Points of Interest)
+///   shows the stages next to the log stream
+/// - Stage names follow the C++ tracer (`example_/Trace.h`): detection, inference, smoothing
+/// - Signposts are near free unless Instruments is recording; build with the `FER_NO_TRACING`
+///   compilation condition to compile them out entirely
+enum Trace {
+    static let signposter = OSSignposter(subsystem: Log.subsystem, category: Log.category)
+
+    /// Runs `body` inside a signpost interval named `name`
+    @discardableResult
+    @inline(__always)
+    static func interval<T>(_ name: StaticString, _ body: () throws -> T) rethrows -> T {
+        #if FER_NO_TRACING
+        return try body()
+        #else
+        return try signposter.withIntervalSignpost(name, around: body)
+        #endif
+    }
+
+    /// Marks a single point in time, e.g. a dropped frame
+    @inline(__always)
+    static func event(_ name: StaticString) {
+        #if !FER_NO_TRACING
+        signposter.emitEvent(name)
+        #endif
+    }
+}
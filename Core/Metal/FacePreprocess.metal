@@ -0,0 +1,32 @@
+#include <metal_stdlib>
+#include "FacePreprocessing.h"
+using namespace metal;
+
+// Crop + grayscale + resize + normalize for every face in one dispatch.
+// Grid is (outputWidth, outputHeight, faceCount); each thread samples the camera texture
+// bilinearly at its output pixel's center inside its face rectangle and writes the
+// normalized gray value to every channel of that face's tensor. Rectangles are in the
+// upright image; params.orientation maps each sample point onto the texture as stored.
+kernel void facePreprocessKernel(texture2d<float, access::sample> inTexture [[texture(0)]],
+                                 constant FaceRect *faces [[buffer(0)]],
+                                 constant FacePreprocessParams &params [[buffer(1)]],
+                                 device float *output [[buffer(2)]],
+                                 uint3 gid [[thread_position_in_grid]])
+{
+    if (gid.x >= params.outputWidth || gid.y >= params.outputHeight || gid.z >= params.faceCount) {
+        return;
+    }
+
+    constexpr sampler bilinear(coord::normalized, address::clamp_to_edge, filter::linear);
+
+    const FaceRect face = faces[gid.z];
+    const float u = faceSourceCoordinate(face.x, face.width, gid.x, params.outputWidth);
+    const float v = faceSourceCoordinate(face.y, face.height, gid.y, params.outputHeight);
+    const float2 uv = float2(faceStoredX(u, v, params.orientation), faceStoredY(u, v, params.orientation));
+    const float4 color = inTexture.sample(bilinear, uv);
+    const float value = faceNormalize(faceLuma(color.r, color.g, color.b), params.scale, params.bias);
+
+    for (uint c = 0; c < params.channels; ++c) {
+        output[faceTensorIndex(gid.z, c, gid.y, gid.x, params.channels, params.outputHeight, params.outputWidth)] = value;
+    }
+}
@@ -0,0 +1,88 @@
+//
+//  FacePreprocessing.h
+//  FacialExpressionDetection
+//
+//  Shared by FacePreprocess.metal (GPU) and example_/FacePreprocessor.h (CPU), so both
+//  crop + grayscale + resize + normalize paths use one definition of the math and layout.
+//
+
+#pragma once
+
+#ifdef __METAL_VERSION__
+#include <metal_stdlib>
+#define FER_CONSTANT constant
+#else
+#include <cstdint>
+#define FER_CONSTANT inline constexpr
+#endif
+
+// Rec. 601 luma, same coefficients as grayscaleKernel.
+FER_CONSTANT float kFaceLumaR = 0.299f;
+FER_CONSTANT float kFaceLumaG = 0.587f;
+FER_CONSTANT float kFaceLumaB = 0.114f;
+
+// Face rectangle in normalized image coordinates with a top-left origin.
+// Mirrored by `FaceRect` in MetalFacePreprocessor.swift; keep the layouts identical.
+struct FaceRect {
+    float x;
+    float y;
+    float width;
+    float height;
+};
+
+// CGImagePropertyOrientation (EXIF) value of the source frame: how its stored rows and
+// columns map onto the upright image the face rectangles are given in, e.g. 6 (.right) for
+// the back camera's landscape buffers.
+FER_CONSTANT uint32_t kFaceOrientationUp = 1;
+
+// Output layout is NCHW float32: faceCount × channels × outputHeight × outputWidth, with the
+// gray value replicated into every channel. value = gray * scale + bias, gray in [0, 1].
+// Mirrored by `FacePreprocessParams` in MetalFacePreprocessor.swift.
+struct FacePreprocessParams {
+    uint32_t outputWidth;
+    uint32_t outputHeight;
+    uint32_t channels;
+    uint32_t faceCount;
+    float scale;
+    float bias;
+    uint32_t orientation;  // kFaceOrientationUp for frames stored upright.
+};
+
+// Normalized source coordinate of output pixel `index`'s center along one axis of a face.
+// Bilinear sampling at this point matches INTER_LINEAR / a linear Metal sampler.
+inline float faceSourceCoordinate(float origin, float extent, uint32_t index, uint32_t outputSize) {
+    return origin + (static_cast<float>(index) + 0.5f) / static_cast<float>(outputSize) * extent;
+}
+
+// Normalized stored-frame coordinate of the upright coordinate (u, v), both top-left origin.
+inline float faceStoredX(float u, float v, uint32_t orientation) {
+    switch (orientation) {
+    case 2: case 3: return 1.0f - u;
+    case 5: case 6: return v;
+    case 7: case 8: return 1.0f - v;
+    default: return u;
+    }
+}
+
+inline float faceStoredY(float u, float v, uint32_t orientation) {
+    switch (orientation) {
+    case 3: case 4: return 1.0f - v;
+    case 5: case 8: return u;
+    case 6: case 7: return 1.0f - u;
+    default: return v;
+    }
+}
+
+inline float faceLuma(float r, float g, float b) {
+    return kFaceLumaR * r + kFaceLumaG * g + kFaceLumaB * b;
+}
+
+inline float faceNormalize(float gray, float scale, float bias) {
+    return gray * scale + bias;
+}
+
+// Flat index of (face, channel, y, x) in the NCHW output.
+inline uint32_t faceTensorIndex(uint32_t face, uint32_t channel, uint32_t y, uint32_t x,
+                                uint32_t channels, uint32_t height, uint32_t width) {
+    return ((face * channels + channel) * height + y) * width + x;
+}
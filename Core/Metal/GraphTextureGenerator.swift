@@ -13,9 +13,7 @@ class GraphTextureGenerator {
     private let device: MTLDevice
     private let textureCache: CVMetalTextureCache
     private let textureSize: CGSize
-    private let targetFPS: Double = 15.0  // Match UI update rate
 
-    private var lastRenderTime: Date = .distantPast
     private var cachedTexture: MTLTexture?
     private var renderer: ImageRenderer<ProbabilityTimelineGraph>?
     private var reusableContext: CGContext?
@@ -48,16 +46,8 @@ class GraphTextureGenerator {
     /// Render probability history to Metal texture
     /// - Parameter history: Probability history array [[Float]]
     /// - Returns: Metal texture or nil if rendering fails
+    /// - Note: Renders on every call; `GraphRenderScheduler` decides when a redraw is due
     func render(history: [[Float]]) -> MTLTexture? {
-        // Throttle to target FPS
-        let now = Date()
-        let minInterval = 1.0 / targetFPS
-        guard now.timeIntervalSince(lastRenderTime) >= minInterval else {
-            // Return cached texture if within throttle interval
-            return cachedTexture
-        }
-        lastRenderTime = now
-
         // Create or update renderer
         let graph = ProbabilityTimelineGraph(history: history)
         if renderer == nil {
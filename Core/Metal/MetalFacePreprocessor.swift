@@ -0,0 +1,151 @@
+import Foundation
+import Metal
+import CoreVideo
+import CoreGraphics
+import ImageIO
+
+/// Mirrors `FaceRect` in FacePreprocessing.h (normalized, top-left origin)
+struct FaceRect {
+    var x: Float
+    var y: Float
+    var width: Float
+    var height: Float
+}
+
+/// Mirrors `FacePreprocessParams` in FacePreprocessing.h
+struct FacePreprocessParams {
+    var outputWidth: UInt32
+    var outputHeight: UInt32
+    var channels: UInt32
+    var faceCount: UInt32
+    var scale: Float
+    var bias: Float
+    var orientation: UInt32  // CGImagePropertyOrientation raw value
+}
+
+/// Fused crop + grayscale + resize + normalize for every face of a frame in one Metal dispatch.
+/// Writes NCHW float32 tensors into a shared buffer allocated once for `maxFaces`, so CoreML can
+/// read them in place. The math lives in FacePreprocessing.h, shared with the C++ path in
+/// `example_/FacePreprocessor.h`.
+class MetalFacePreprocessor {
+    private let device: MTLDevice
+    private let commandQueue: MTLCommandQueue
+    private let computePipelineState: MTLComputePipelineState
+    private var textureCache: CVMetalTextureCache?
+    private var params: FacePreprocessParams
+    private var rects: [FaceRect]
+
+    let maxFaces: Int
+    /// `maxFaces × channels × height × width` floats
+    let output: MTLBuffer
+
+    var width: UInt32 { params.outputWidth }
+    var height: UInt32 { params.outputHeight }
+    /// Floats per face in `output`
+    var faceStride: Int { Int(params.channels * params.outputHeight * params.outputWidth) }
+
+    init?(maxFaces: Int, width: Int = 128, height: Int = 128, channels: Int = 1,
+          scale: Float = 1.0, bias: Float = 0.0) {
+        guard let device = MTLCreateSystemDefaultDevice(),
+              let commandQueue = device.makeCommandQueue(),
+              let library = device.makeDefaultLibrary() else {
+            Log.error("Failed to initialize Metal")
+            return nil
+        }
+
+        do {
+            guard let kernelFunction = library.makeFunction(name: "facePreprocessKernel") else {
+                Log.error("Failed to find facePreprocessKernel in default library")
+                return nil
+            }
+            self.computePipelineState = try device.makeComputePipelineState(function: kernelFunction)
+        } catch {
+            Log.error("Failed to create compute pipeline: \(error)")
+            return nil
+        }
+
+        let faceCapacity = max(1, maxFaces)
+        let length = faceCapacity * channels * height * width * MemoryLayout<Float>.stride
+        guard let output = device.makeBuffer(length: length, options: .storageModeShared) else {
+            Log.error("Failed to allocate face tensor buffer")
+            return nil
+        }
+
+        self.device = device
+        self.commandQueue = commandQueue
+        self.maxFaces = faceCapacity
+        self.output = output
+        self.params = FacePreprocessParams(outputWidth: UInt32(width), outputHeight: UInt32(height),
+                                           channels: UInt32(channels), faceCount: 0, scale: scale, bias: bias,
+                                           orientation: CGImagePropertyOrientation.up.rawValue)
+        self.rects = []
+        self.rects.reserveCapacity(faceCapacity)
+
+        var cache: CVMetalTextureCache?
+        CVMetalTextureCacheCreate(kCFAllocatorDefault, nil, device, nil, &cache)
+        self.textureCache = cache
+    }
+
+    /// Preprocess `rois` (normalized, lower-left origin like Vision, in the frame as seen through
+    /// `orientation`) of a BGRA frame. Returns the number of faces written to `output`, or nil if the
+    /// dispatch failed.
+    func preprocess(pixelBuffer: CVPixelBuffer, orientation: CGImagePropertyOrientation = .up, rois: [CGRect]) -> Int? {
+        rects.removeAll(keepingCapacity: true)
+        for roi in rois.prefix(maxFaces) {
+            rects.append(FaceRect(x: Float(roi.minX), y: Float(1 - roi.maxY),
+                                  width: Float(roi.width), height: Float(roi.height)))
+        }
+        guard !rects.isEmpty else { return 0 }
+        params.faceCount = UInt32(rects.count)
+        params.orientation = orientation.rawValue
+
+        guard let inputTexture = createTexture(from: pixelBuffer),
+              let commandBuffer = commandQueue.makeCommandBuffer(),
+              let encoder = commandBuffer.makeComputeCommandEncoder() else {
+            return nil
+        }
+
+        encoder.setComputePipelineState(computePipelineState)
+        encoder.setTexture(inputTexture, index: 0)
+        rects.withUnsafeBytes { encoder.setBytes($0.baseAddress!, length: $0.count, index: 0) }
+        encoder.setBytes(&params, length: MemoryLayout<FacePreprocessParams>.stride, index: 1)
+        encoder.setBuffer(output, offset: 0, index: 2)
+
+        let threadGroupSize = MTLSizeMake(16, 16, 1)
+        let threadGroups = MTLSizeMake(
+            (Int(params.outputWidth) + threadGroupSize.width - 1) / threadGroupSize.width,
+            (Int(params.outputHeight) + threadGroupSize.height - 1) / threadGroupSize.height,
+            rects.count
+        )
+
+        encoder.dispatchThreadgroups(threadGroups, threadsPerThreadgroup: threadGroupSize)
+        encoder.endEncoding()
+
+        commandBuffer.commit()
+        commandBuffer.waitUntilCompleted()
+        return rects.count
+    }
+
+    private func createTexture(from pixelBuffer: CVPixelBuffer) -> MTLTexture? {
+        guard let textureCache = textureCache else { return nil }
+
+        var cvTextureOut: CVMetalTexture?
+        let status = CVMetalTextureCacheCreateTextureFromImage(
+            kCFAllocatorDefault,
+            textureCache,
+            pixelBuffer,
+            nil,
+            .bgra8Unorm,
+            CVPixelBufferGetWidth(pixelBuffer),
+            CVPixelBufferGetHeight(pixelBuffer),
+            0,
+            &cvTextureOut
+        )
+
+        guard status == kCVReturnSuccess, let cvTexture = cvTextureOut else {
+            return nil
+        }
+
+        return CVMetalTextureGetTexture(cvTexture)
+    }
+}
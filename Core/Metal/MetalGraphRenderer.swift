@@ -0,0 +1,255 @@
+import Foundation
+import Metal
+import MetalKit
+import RealityKit
+import SwiftUI
+import UIKit
+
+/// Mirrors `GraphUniforms` in ProbabilityGraph.metal
+struct GraphUniforms {
+    var viewportSize: SIMD2<Float>
+    var margin: Float
+    var startY: Float
+    var laneHeight: Float
+    var laneSpacing: Float
+    var lineWidth: Float
+    var opacity: Float
+    var frameCount: UInt32
+    var laneCount: UInt32
+    var glowOnly: UInt32
+    var padding: UInt32 = 0
+}
+
+/// Draws the AR probability graph on the GPU, replacing the CoreGraphics rasterization and
+/// texture upload of `GraphTextureGenerator`
+/// - The newest `maxFrames` history frames are passed inline with `setVertexBytes` (about 2 KB for
+///   75 frames), so every command buffer gets its own copy and a redraw never overwrites samples
+///   the previous, possibly still running, draw reads; each lane's polyline is expanded into quads
+///   by `graphLineVertex` (one instance per lane)
+/// - Lane backgrounds and labels never change, so they are drawn once into a static texture
+/// - Renders into a RealityKit `TextureResource.DrawableQueue`, so the graph never leaves the GPU
+/// - Same layout as `ProbabilityTimelineGraph`: 7 lanes, newest frame on the right, a glow on
+///   lanes dominant in the last 5 frames
+@MainActor
+final class MetalGraphRenderer {
+
+    // MARK: - Properties
+
+    private let device: MTLDevice
+    private let commandQueue: MTLCommandQueue
+    private let linePipeline: MTLRenderPipelineState
+    private let backgroundPipeline: MTLRenderPipelineState
+    private let colors: MTLBuffer
+    private var samples: [Float]     // Reused frame-major staging for the inline sample bytes
+    private var dominant: [UInt32]   // Per lane: dominant in the last `dominanceWindow` frames
+    private let background: MTLTexture
+    private let size: CGSize
+    private let laneCount: Int
+
+    let maxFrames: Int
+    let drawableQueue: TextureResource.DrawableQueue
+
+    // Geometry of ProbabilityTimelineGraph, in pixels
+    private let laneHeight: Float = 30
+    private let laneSpacing: Float = 4
+    private let margin: Float = 8
+    private let lineWidth: Float = 2
+    private let glowWidth: Float = 8
+    private let glowOpacity: Float = 0.2
+    private let dominanceWindow = 5
+    private static let maxInlineBytes = 4096
+
+    private var startY: Float {
+        let totalHeight = Float(laneCount) * (laneHeight + laneSpacing) - laneSpacing
+        return (Float(size.height) - totalHeight) / 2
+    }
+
+    // MARK: - Initialization
+
+    init?(size: CGSize = CGSize(width: 512, height: 512), maxFrames: Int = 75) {
+        guard let device = MTLCreateSystemDefaultDevice(),
+              let commandQueue = device.makeCommandQueue(),
+              let library = device.makeDefaultLibrary() else {
+            Log.error("[GraphRenderer] Failed to initialize Metal")
+            return nil
+        }
+
+        let laneCount = min(emotionClasses.count, emotionColors.count)
+        let width = max(Int(size.width), 1)
+        let height = max(Int(size.height), 1)
+
+        do {
+            let descriptor = MTLRenderPipelineDescriptor()
+            descriptor.vertexFunction = library.makeFunction(name: "graphLineVertex")
+            descriptor.fragmentFunction = library.makeFunction(name: "graphLineFragment")
+            descriptor.colorAttachments[0].pixelFormat = .bgra8Unorm
+            descriptor.colorAttachments[0].isBlendingEnabled = true
+            descriptor.colorAttachments[0].sourceRGBBlendFactor = .sourceAlpha
+            descriptor.colorAttachments[0].destinationRGBBlendFactor = .oneMinusSourceAlpha
+            descriptor.colorAttachments[0].sourceAlphaBlendFactor = .one
+            descriptor.colorAttachments[0].destinationAlphaBlendFactor = .oneMinusSourceAlpha
+            self.linePipeline = try device.makeRenderPipelineState(descriptor: descriptor)
+
+            descriptor.vertexFunction = library.makeFunction(name: "graphBackgroundVertex")
+            descriptor.fragmentFunction = library.makeFunction(name: "graphBackgroundFragment")
+            descriptor.colorAttachments[0].isBlendingEnabled = false
+            self.backgroundPipeline = try device.makeRenderPipelineState(descriptor: descriptor)
+
+            self.drawableQueue = try TextureResource.DrawableQueue(.init(
+                pixelFormat: .bgra8Unorm, width: width, height: height,
+                usage: [.renderTarget, .shaderRead], mipmapsMode: .none))
+        } catch {
+            Log.error("[GraphRenderer] Failed to create pipelines: \(error)")
+            return nil
+        }
+
+        // setVertexBytes takes at most 4 KB, which caps the frames drawn (146 for 7 lanes)
+        let frameCapacity = min(max(2, maxFrames), Self.maxInlineBytes / (laneCount * MemoryLayout<Float>.stride))
+        guard let colors = device.makeBuffer(bytes: emotionColors.prefix(laneCount).map(\.rgba),
+                                             length: laneCount * MemoryLayout<SIMD4<Float>>.stride,
+                                             options: .storageModeShared) else {
+            Log.error("[GraphRenderer] Failed to allocate buffers")
+            return nil
+        }
+
+        self.device = device
+        self.commandQueue = commandQueue
+        self.colors = colors
+        self.samples = [Float](repeating: 0, count: frameCapacity * laneCount)
+        self.dominant = [UInt32](repeating: 0, count: laneCount)
+        self.size = CGSize(width: width, height: height)
+        self.laneCount = laneCount
+        self.maxFrames = frameCapacity
+
+        guard let background = Self.makeBackground(device: device, size: self.size, laneCount: laneCount,
+                                                   laneHeight: CGFloat(laneHeight), laneSpacing: CGFloat(laneSpacing),
+                                                   margin: CGFloat(margin)) else {
+            Log.error("[GraphRenderer] Failed to create background texture")
+            return nil
+        }
+        self.background = background
+
+        Log.info("[GraphRenderer] Initialized with size: \(self.size)")
+    }
+
+    // MARK: - Rendering
+
+    /// Draw `history` (frames of per-class probabilities, oldest first) into the next drawable
+    /// - Returns: false if no drawable was available or encoding failed
+    @discardableResult
+    func render(history: [[Float]]) -> Bool {
+        let frames = history.suffix(maxFrames)
+
+        // Stage the visible frames, frame-major; they are copied into the command buffer below
+        for lane in 0..<laneCount {
+            dominant[lane] = 0
+        }
+        for (frameIndex, frame) in frames.enumerated() {
+            for lane in 0..<laneCount {
+                samples[frameIndex * laneCount + lane] = lane < frame.count ? frame[lane] : 0
+            }
+            if frameIndex >= frames.count - dominanceWindow,
+               let top = frame.indices.max(by: { frame[$0] < frame[$1] }), top < laneCount {
+                dominant[top] = 1
+            }
+        }
+
+        let drawable: TextureResource.Drawable
+        do {
+            drawable = try drawableQueue.nextDrawable()
+        } catch {
+            Log.warn("[GraphRenderer] No drawable available: \(error)")
+            return false
+        }
+
+        let pass = MTLRenderPassDescriptor()
+        pass.colorAttachments[0].texture = drawable.texture
+        pass.colorAttachments[0].loadAction = .dontCare
+        pass.colorAttachments[0].storeAction = .store
+
+        guard let commandBuffer = commandQueue.makeCommandBuffer(),
+              let encoder = commandBuffer.makeRenderCommandEncoder(descriptor: pass) else {
+            return false
+        }
+
+        // Static lanes and labels cover the whole target, so no clear is needed
+        encoder.setRenderPipelineState(backgroundPipeline)
+        encoder.setFragmentTexture(background, index: 0)
+        encoder.drawPrimitives(type: .triangleStrip, vertexStart: 0, vertexCount: 4)
+
+        if frames.count >= 2 {
+            var uniforms = GraphUniforms(
+                viewportSize: SIMD2(Float(size.width), Float(size.height)),
+                margin: margin, startY: startY, laneHeight: laneHeight, laneSpacing: laneSpacing,
+                lineWidth: glowWidth, opacity: glowOpacity,
+                frameCount: UInt32(frames.count), laneCount: UInt32(laneCount), glowOnly: 1)
+            let vertexCount = (frames.count - 1) * 6
+
+            encoder.setRenderPipelineState(linePipeline)
+            samples.withUnsafeBytes { bytes in
+                encoder.setVertexBytes(bytes.baseAddress!, length: frames.count * laneCount * MemoryLayout<Float>.stride,
+                                       index: 0)
+            }
+            encoder.setVertexBuffer(colors, offset: 0, index: 2)
+            dominant.withUnsafeBytes { encoder.setVertexBytes($0.baseAddress!, length: $0.count, index: 3) }
+
+            // Glow under the recently dominant lanes, then every lane's curve
+            encoder.setVertexBytes(&uniforms, length: MemoryLayout<GraphUniforms>.stride, index: 1)
+            encoder.drawPrimitives(type: .triangle, vertexStart: 0, vertexCount: vertexCount, instanceCount: laneCount)
+
+            uniforms.lineWidth = lineWidth
+            uniforms.opacity = 1
+            uniforms.glowOnly = 0
+            encoder.setVertexBytes(&uniforms, length: MemoryLayout<GraphUniforms>.stride, index: 1)
+            encoder.drawPrimitives(type: .triangle, vertexStart: 0, vertexCount: vertexCount, instanceCount: laneCount)
+        }
+
+        encoder.endEncoding()
+        commandBuffer.commit()
+        drawable.present()
+        return true
+    }
+
+    // MARK: - Static Layer
+
+    /// Lane backgrounds and labels, drawn once with UIKit and uploaded once
+    private static func makeBackground(device: MTLDevice, size: CGSize, laneCount: Int,
+                                       laneHeight: CGFloat, laneSpacing: CGFloat, margin: CGFloat) -> MTLTexture? {
+        let format = UIGraphicsImageRendererFormat()
+        format.scale = 1
+        format.opaque = false
+        let image = UIGraphicsImageRenderer(size: size, format: format).image { _ in
+            let totalHeight = CGFloat(laneCount) * (laneHeight + laneSpacing) - laneSpacing
+            let startY = (size.height - totalHeight) / 2
+            let attributes: [NSAttributedString.Key: Any] = [
+                .font: UIFont.preferredFont(forTextStyle: .caption2),
+                .foregroundColor: UIColor.label
+            ]
+            for lane in 0..<laneCount {
+                let laneY = startY + CGFloat(lane) * (laneHeight + laneSpacing)
+                let laneRect = CGRect(x: margin, y: laneY, width: size.width - 2 * margin, height: laneHeight)
+                UIColor.gray.withAlphaComponent(0.05).setFill()
+                UIBezierPath(roundedRect: laneRect, cornerRadius: 4).fill()
+                (emotionClasses[lane].capitalized as NSString)
+                    .draw(at: CGPoint(x: margin + 4, y: laneY + 4), withAttributes: attributes)
+            }
+        }
+        guard let cgImage = image.cgImage else { return nil }
+        return try? MTKTextureLoader(device: device).newTexture(cgImage: cgImage, options: [
+            .SRGB: false,
+            .textureUsage: MTLTextureUsage.shaderRead.rawValue,
+            .textureStorageMode: MTLStorageMode.private.rawValue
+        ])
+    }
+}
+
+// MARK: - Color Conversion
+
+private extension Color {
+    /// Straight (non-premultiplied) RGBA components in 0 ... 1
+    var rgba: SIMD4<Float> {
+        var red: CGFloat = 0, green: CGFloat = 0, blue: CGFloat = 0, alpha: CGFloat = 0
+        UIColor(self).getRed(&red, green: &green, blue: &blue, alpha: &alpha)
+        return SIMD4(Float(red), Float(green), Float(blue), Float(alpha))
+    }
+}
@@ -8,6 +8,12 @@ class MetalGrayscaleConverter {
     private let commandQueue: MTLCommandQueue
     private let computePipelineState: MTLComputePipelineState
     private var textureCache: CVMetalTextureCache?
+    private let ciContext: CIContext
+
+    // Output buffers are recycled: two frames in flight (Vision + batch predictor) plus one spare
+    let outputPool = PixelBufferPool(capacity: 3)
+    private let statsInterval = 300  // Conversions between pool log lines
+    private var conversions = 0
     
     init?() {
         guard let device = MTLCreateSystemDefaultDevice(),
@@ -19,6 +25,7 @@ class MetalGrayscaleConverter {
         
         self.device = device
         self.commandQueue = commandQueue
+        self.ciContext = CIContext(mtlDevice: device, options: [.workingColorSpace: NSNull()])
         
         do {
             guard let kernelFunction = library.makeFunction(name: "grayscaleKernel") else {
@@ -45,20 +52,16 @@ class MetalGrayscaleConverter {
             return nil
         }
         
-        // 2. Create Output Pixel Buffer (reused or new)
-        // For efficiency, we should maintain a pool, but for now we create one.
+        // 2. Output Pixel Buffer from the pool (recycled once the caller drops it)
         // Ideally, we want a 1-channel output (Luma), but Vision/CoreML often expects 32BGRA.
         // Let's stick to 32BGRA for compatibility, but with grayscale content.
-        var outputPixelBuffer: CVPixelBuffer?
-        let attrs = [
-            kCVPixelBufferMetalCompatibilityKey: true,
-            kCVPixelBufferIOSurfacePropertiesKey: [:]
-        ] as CFDictionary
-        
-        let status = CVPixelBufferCreate(kCFAllocatorDefault, width, height, kCVPixelFormatType_32BGRA, attrs, &outputPixelBuffer)
-        guard status == kCVReturnSuccess, let outputBuffer = outputPixelBuffer else {
+        guard let outputBuffer = outputPool.acquire(width: width, height: height) else {
             return nil
         }
+        conversions += 1
+        if conversions % statsInterval == 0 {
+            Log.debug("[MetalGrayscaleConverter] Output pool: \(outputPool.stats)")
+        }
         
         guard let outputTexture = createTexture(from: outputBuffer, pixelFormat: .bgra8Unorm, planeIndex: 0) else {
             return nil
@@ -89,7 +92,6 @@ class MetalGrayscaleConverter {
 
         // 4. Apply Histogram Equalization (matches C++ preprocessing: equalizeHist)
         // This improves model performance in varying lighting conditions
-        let ciContext = CIContext(mtlDevice: device, options: [.workingColorSpace: NSNull()])
         var ciImage = CIImage(cvPixelBuffer: outputBuffer)
 
         // CoreImage doesn't have direct histogram equalization, but we can approximate it
@@ -0,0 +1,119 @@
+import Foundation
+import CoreVideo
+import os
+
+/// Fixed-size pool of IOSurface-backed, Metal-compatible pixel buffers (the iOS side of
+/// `example_/FramePool.h`)
+/// - Wraps a `CVPixelBufferPool` that is filled to `capacity` up front, so steady-state
+///   `acquire` hands out a recycled buffer and allocates nothing
+/// - Release is CoreVideo's: a buffer goes back to the pool when its last reference is dropped;
+///   a request while all `capacity` buffers are out is a miss and allocates beyond the limit
+/// - Frames of another size or format rebuild the pool; the rebuild also counts as a miss
+final class PixelBufferPool: @unchecked Sendable {
+
+    // MARK: - Types
+
+    struct Stats: CustomStringConvertible {
+        var hits = 0
+        var misses = 0
+
+        var description: String { "\(hits) hits, \(misses) misses" }
+    }
+
+    // MARK: - Properties
+
+    let capacity: Int
+    private let lock = OSAllocatedUnfairLock()
+    private var pool: CVPixelBufferPool?
+    private var width = 0
+    private var height = 0
+    private var pixelFormat: OSType = 0
+    private var counters = Stats()
+    private let thresholdOptions: CFDictionary
+
+    var stats: Stats { lock.withLock { counters } }
+
+    // MARK: - Initialization
+
+    init(capacity: Int = 3) {
+        self.capacity = max(capacity, 1)
+        self.thresholdOptions = [kCVPixelBufferPoolAllocationThresholdKey: self.capacity] as CFDictionary
+    }
+
+    // MARK: - Acquire
+
+    /// A buffer of the given size and format, recycled when possible
+    func acquire(width: Int, height: Int, pixelFormat: OSType = kCVPixelFormatType_32BGRA) -> CVPixelBuffer? {
+        lock.lock()
+        defer { lock.unlock() }
+
+        if pool == nil || width != self.width || height != self.height || pixelFormat != self.pixelFormat {
+            guard makePool(width: width, height: height, pixelFormat: pixelFormat) else { return nil }
+            counters.misses += 1
+        }
+        guard let pool = pool else { return nil }
+
+        var buffer: CVPixelBuffer?
+        let status = CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(kCFAllocatorDefault, pool,
+                                                                         thresholdOptions, &buffer)
+        if status == kCVReturnSuccess, let buffer = buffer {
+            counters.hits += 1
+            return buffer
+        }
+        // Every prefilled buffer is still in use: grow past the threshold rather than drop the frame
+        counters.misses += 1
+        CVPixelBufferPoolCreatePixelBuffer(kCFAllocatorDefault, pool, &buffer)
+        return buffer
+    }
+
+    /// Drop idle buffers, e.g. when the app is backgrounded
+    func flush() {
+        lock.lock()
+        defer { lock.unlock() }
+        if let pool = pool {
+            CVPixelBufferPoolFlush(pool, .excessBuffers)
+        }
+    }
+
+    // MARK: - Private Methods
+
+    private func makePool(width: Int, height: Int, pixelFormat: OSType) -> Bool {
+        if let old = pool {
+            CVPixelBufferPoolFlush(old, .excessBuffers)
+        }
+        let poolAttributes = [kCVPixelBufferPoolMinimumBufferCountKey: capacity] as CFDictionary
+        let bufferAttributes = [
+            kCVPixelBufferWidthKey: width,
+            kCVPixelBufferHeightKey: height,
+            kCVPixelBufferPixelFormatTypeKey: pixelFormat,
+            kCVPixelBufferMetalCompatibilityKey: true,
+            kCVPixelBufferIOSurfacePropertiesKey: [:]
+        ] as CFDictionary
+
+        var newPool: CVPixelBufferPool?
+        guard CVPixelBufferPoolCreate(kCFAllocatorDefault, poolAttributes, bufferAttributes, &newPool) == kCVReturnSuccess,
+              let newPool = newPool else {
+            Log.error("[PixelBufferPool] Failed to create pool for \(width)x\(height)")
+            pool = nil
+            return false
+        }
+
+        // Prefill, so the first frames are recycled buffers too
+        var prefill: [CVPixelBuffer] = []
+        for _ in 0..<capacity {
+            var buffer: CVPixelBuffer?
+            CVPixelBufferPoolCreatePixelBuffer(kCFAllocatorDefault, newPool, &buffer)
+            if let buffer = buffer {
+                prefill.append(buffer)
+            }
+        }
+        prefill.removeAll()
+
+        pool = newPool
+        self.width = width
+        self.height = height
+        self.pixelFormat = pixelFormat
+        Log.info("[PixelBufferPool] \(capacity) buffers of \(width)x\(height)")
+        return true
+    }
+}
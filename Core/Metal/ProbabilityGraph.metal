@@ -0,0 +1,99 @@
+#include <metal_stdlib>
+using namespace metal;
+
+// Per-draw constants for the AR probability graph, in pixels with a top-left origin.
+// Mirrored by `GraphUniforms` in MetalGraphRenderer.swift; keep the layouts identical.
+struct GraphUniforms {
+    float2 viewportSize;
+    float margin;
+    float startY;        // Top of the first lane.
+    float laneHeight;
+    float laneSpacing;
+    float lineWidth;
+    float opacity;
+    uint frameCount;     // Frames in `samples`, oldest first.
+    uint laneCount;
+    uint glowOnly;       // 1: draw only the lanes flagged in `glowing`.
+    uint padding;
+};
+
+struct GraphVertexOut {
+    float4 position [[position]];
+    float4 color;
+    float across;        // -1 ... 1 across the stroke, for edge antialiasing.
+    float feather;       // Fraction of the half-width that fades out.
+};
+
+// One instance per lane, six vertices (two triangles) per segment between consecutive frames.
+// samples is frame-major: samples[frame * laneCount + lane].
+vertex GraphVertexOut graphLineVertex(constant float *samples [[buffer(0)]],
+                                      constant GraphUniforms &uniforms [[buffer(1)]],
+                                      constant float4 *colors [[buffer(2)]],
+                                      constant uint *glowing [[buffer(3)]],
+                                      uint vid [[vertex_id]],
+                                      uint lane [[instance_id]])
+{
+    GraphVertexOut out;
+    out.color = float4(colors[lane].rgb, colors[lane].a * uniforms.opacity);
+    out.across = 0;
+    out.feather = 0;
+
+    const uint segment = vid / 6;
+    if (uniforms.frameCount < 2 || segment + 1 >= uniforms.frameCount ||
+        (uniforms.glowOnly != 0 && glowing[lane] == 0)) {
+        out.position = float4(-2.0, -2.0, 0.0, 1.0);  // Degenerate, culled.
+        return out;
+    }
+
+    const float graphWidth = uniforms.viewportSize.x - 2.0 * uniforms.margin;
+    const float frameWidth = graphWidth / float(uniforms.frameCount - 1);
+    const float laneY = uniforms.startY + float(lane) * (uniforms.laneHeight + uniforms.laneSpacing);
+    const float p0 = saturate(samples[segment * uniforms.laneCount + lane]);
+    const float p1 = saturate(samples[(segment + 1) * uniforms.laneCount + lane]);
+    const float2 a = float2(uniforms.margin + float(segment) * frameWidth, laneY + uniforms.laneHeight * (1.0 - p0));
+    const float2 b = float2(uniforms.margin + float(segment + 1) * frameWidth, laneY + uniforms.laneHeight * (1.0 - p1));
+
+    // Quad around the segment, extended by half a width at both ends so joints overlap.
+    const float halfWidth = 0.5 * uniforms.lineWidth + 1.0;
+    const float2 direction = normalize(b - a + float2(1e-6, 0.0));
+    const float2 normal = float2(-direction.y, direction.x) * halfWidth;
+    const float2 extend = direction * 0.5 * uniforms.lineWidth;
+    const uint corner = vid % 6;
+    const bool atEnd = corner == 2 || corner == 3 || corner == 5;
+    const float side = (corner == 1 || corner == 4 || corner == 5) ? 1.0 : -1.0;
+    const float2 point = (atEnd ? b + extend : a - extend) + normal * side;
+
+    out.position = float4(point.x / uniforms.viewportSize.x * 2.0 - 1.0,
+                          1.0 - point.y / uniforms.viewportSize.y * 2.0, 0.0, 1.0);
+    out.across = side;
+    out.feather = 1.0 / halfWidth;  // Fade over the outer pixel.
+    return out;
+}
+
+fragment float4 graphLineFragment(GraphVertexOut in [[stage_in]])
+{
+    const float alpha = 1.0 - smoothstep(1.0 - in.feather, 1.0, abs(in.across));
+    return float4(in.color.rgb, in.color.a * alpha);
+}
+
+struct GraphBackgroundOut {
+    float4 position [[position]];
+    float2 uv;
+};
+
+// Full-viewport quad as a four-vertex triangle strip.
+vertex GraphBackgroundOut graphBackgroundVertex(uint vid [[vertex_id]])
+{
+    const float2 uv = float2(float(vid & 1), float(vid >> 1));
+    GraphBackgroundOut out;
+    out.position = float4(uv.x * 2.0 - 1.0, 1.0 - uv.y * 2.0, 0.0, 1.0);
+    out.uv = uv;
+    return out;
+}
+
+fragment float4 graphBackgroundFragment(GraphBackgroundOut in [[stage_in]],
+                                        texture2d<float, access::sample> background [[texture(0)]])
+{
+    constexpr sampler nearest(coord::normalized, address::clamp_to_edge, filter::nearest);
+    return background.sample(nearest, in.uv);
+}
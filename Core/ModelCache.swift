@@ -0,0 +1,160 @@
+import Foundation
+import CoreML
+import CoreVideo
+import Vision
+import os
+
+/// Compiled, loaded and warmed-up models for every `MLModelType`, so switching models is a
+/// lookup instead of a compile + load on the first frames
+/// - `warmUp` loads each model on a background queue, the selected one first, and runs one
+///   dummy inference on zeros so CoreML finishes its device-specific preparation (ANE / GPU
+///   compilation) before the first camera frame
+/// - The Vision request and batch predictor are built once per model and reused; they are
+///   meant for one predictor at a time (`FERPredictor`)
+final class ModelCache: @unchecked Sendable {
+
+    // MARK: - Types
+
+    final class LoadedModel {
+        let type: MLModelType
+        let mlModel: MLModel
+        let visionModel: VNCoreMLModel
+        let request: VNCoreMLRequest
+        let batchPredictor: FaceBatchPredictor?
+
+        init(type: MLModelType, mlModel: MLModel, visionModel: VNCoreMLModel, batchCapacity: Int) {
+            self.type = type
+            self.mlModel = mlModel
+            self.visionModel = visionModel
+            let request = VNCoreMLRequest(model: visionModel)
+            request.imageCropAndScaleOption = .scaleFill
+            self.request = request
+            self.batchPredictor = FaceBatchPredictor(model: mlModel, capacity: batchCapacity)
+        }
+    }
+
+    // MARK: - Properties
+
+    static let shared = ModelCache()
+
+    /// Faces per batch the cached batch predictors are sized for (`FERPredictor.maxTrackedFaces`)
+    let batchCapacity: Int
+
+    private let loadQueue = DispatchQueue(label: "com.fer.modelcache", qos: .userInitiated)
+    private let models = OSAllocatedUnfairLock(initialState: [MLModelType: LoadedModel]())
+    private var warmedUp = false  // Only touched on loadQueue
+
+    init(batchCapacity: Int = 4) {
+        self.batchCapacity = batchCapacity
+    }
+
+    // MARK: - Access
+
+    /// The model if it is already loaded; never blocks
+    func cached(_ type: MLModelType) -> LoadedModel? {
+        models.withLock { $0[type] }
+    }
+
+    /// Loads `type` in the background (or finds it cached) and calls `completion` on the main queue
+    /// - Queued behind any model being warmed up, then shares its result if it was that one
+    func load(_ type: MLModelType, completion: @escaping (LoadedModel?) -> Void) {
+        if let model = cached(type) {
+            DispatchQueue.main.async { completion(model) }
+            return
+        }
+        loadQueue.async {
+            let model = self.loadIfNeeded(type)
+            DispatchQueue.main.async { completion(model) }
+        }
+    }
+
+    /// Load and warm every model type in the background, `first` before the others
+    func warmUp(first: MLModelType? = nil) {
+        loadQueue.async {
+            guard !self.warmedUp else { return }
+            self.warmedUp = true
+            let order = (first.map { [$0] } ?? []) + MLModelType.allCases.filter { $0 != first }
+            for type in order {
+                // One queue item per model, so a `load` for another type can run in between
+                self.loadQueue.async { _ = self.loadIfNeeded(type) }
+            }
+        }
+    }
+
+    // MARK: - Loading
+
+    private func loadIfNeeded(_ type: MLModelType) -> LoadedModel? {
+        dispatchPrecondition(condition: .onQueue(loadQueue))
+        if let model = cached(type) {
+            return model
+        }
+        let start = DispatchTime.now().uptimeNanoseconds
+        guard let model = Self.loadModel(type, batchCapacity: batchCapacity) else { return nil }
+        Self.warm(model.mlModel)
+        models.withLock { $0[type] = model }
+        let elapsed = Double(DispatchTime.now().uptimeNanoseconds - start) / 1e6
+        Log.info("[ModelCache] '\(type.displayName)' loaded and warmed in \(String(format: "%.0f", elapsed)) ms")
+        return model
+    }
+
+    private static func loadModel(_ type: MLModelType, batchCapacity: Int) -> LoadedModel? {
+        let modelName = type.rawValue
+        guard let modelURL = Bundle.main.url(forResource: modelName, withExtension: "mlmodelc") ??
+                             Bundle.main.url(forResource: modelName, withExtension: "mlpackage") else {
+            Log.warn("[ModelCache] Model '\(modelName)' not found in bundle")
+            return nil
+        }
+
+        do {
+            let compiledURL: URL
+            if modelURL.pathExtension == "mlpackage" || modelURL.pathExtension == "mlmodel" {
+                compiledURL = try MLModel.compileModel(at: modelURL)
+            } else {
+                compiledURL = modelURL
+            }
+
+            // Configure for ANE usage
+            let config = MLModelConfiguration()
+            config.computeUnits = .all // Explicitly allow ANE, GPU, and CPU
+
+            let mlModel = try MLModel(contentsOf: compiledURL, configuration: config)
+            let visionModel = try VNCoreMLModel(for: mlModel)
+            return LoadedModel(type: type, mlModel: mlModel, visionModel: visionModel, batchCapacity: batchCapacity)
+        } catch {
+            Log.error("[ModelCache] Error loading model '\(modelName)': \(error)")
+            return nil
+        }
+    }
+
+    /// One inference on zeros (a blank 128x128 face for the FER models) to finish model preparation
+    private static func warm(_ model: MLModel) {
+        var features: [String: MLFeatureValue] = [:]
+        for (name, description) in model.modelDescription.inputDescriptionsByName {
+            if let constraint = description.imageConstraint {
+                var buffer: CVPixelBuffer?
+                guard CVPixelBufferCreate(kCFAllocatorDefault, constraint.pixelsWide, constraint.pixelsHigh,
+                                          constraint.pixelFormatType, nil, &buffer) == kCVReturnSuccess,
+                      let buffer = buffer else { return }
+                CVPixelBufferLockBaseAddress(buffer, [])
+                if let base = CVPixelBufferGetBaseAddress(buffer) {
+                    memset(base, 0, CVPixelBufferGetDataSize(buffer))
+                }
+                CVPixelBufferUnlockBaseAddress(buffer, [])
+                features[name] = MLFeatureValue(pixelBuffer: buffer)
+            } else if let constraint = description.multiArrayConstraint,
+                      let array = try? MLMultiArray(shape: constraint.shape, dataType: constraint.dataType) {
+                array.withUnsafeMutableBytes { bytes, _ in
+                    if let base = bytes.baseAddress { memset(base, 0, bytes.count) }
+                }
+                features[name] = MLFeatureValue(multiArray: array)
+            }
+        }
+
+        do {
+            let input = try MLDictionaryFeatureProvider(dictionary: features)
+            _ = try model.prediction(from: input)
+        } catch {
+            Log.warn("[ModelCache] Warm-up inference failed: \(error)")
+        }
+    }
+}
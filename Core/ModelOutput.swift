@@ -0,0 +1,65 @@
+import Accelerate
+import CoreML
+
+/// Model output stage: logits straight from an `MLMultiArray`'s buffer to probabilities in
+/// caller-provided storage (mirrors `example_/ModelOutput.h`)
+/// - Reads float32 in place and converts float16 with one vImage pass, so there is no
+///   per-element `NSNumber` bridging
+/// - Numerically stable softmax (max subtracted before `exp`) with vDSP / vForce, no temporaries
+/// - Non-finite logits give a uniform distribution and `false`, like the C++ stage
+enum ModelOutput {
+
+    /// Softmax of the logits in `multiArray` into `out`
+    /// - `multiArray` must be float16 or float32 with exactly `out.count` elements and a
+    ///   contiguous innermost dimension, e.g. shape [1, 7]
+    @discardableResult
+    static func softmax(_ multiArray: MLMultiArray, into out: UnsafeMutableBufferPointer<Float>) -> Bool {
+        guard let output = out.baseAddress, out.count > 0, multiArray.count == out.count,
+              (multiArray.strides.last?.intValue ?? 1) == 1 else {
+            return false
+        }
+        let count = out.count
+        let decoded: Bool = multiArray.withUnsafeBytes { bytes in
+            guard let input = bytes.baseAddress else { return false }
+            switch multiArray.dataType {
+            case .float32:
+                output.update(from: input.assumingMemoryBound(to: Float.self), count: count)
+                return true
+            case .float16:
+                var source = vImage_Buffer(data: UnsafeMutableRawPointer(mutating: input), height: 1,
+                                           width: vImagePixelCount(count), rowBytes: count * MemoryLayout<UInt16>.stride)
+                var destination = vImage_Buffer(data: output, height: 1, width: vImagePixelCount(count),
+                                                rowBytes: count * MemoryLayout<Float>.stride)
+                return vImageConvert_Planar16FtoPlanarF(&source, &destination, vImage_Flags(kvImageNoFlags)) == kvImageNoError
+            default:
+                return false
+            }
+        }
+        guard decoded else { return false }
+        return softmaxInPlace(out)
+    }
+
+    /// Numerically stable softmax over `values`, in place
+    @discardableResult
+    static func softmaxInPlace(_ values: UnsafeMutableBufferPointer<Float>) -> Bool {
+        guard let base = values.baseAddress, values.count > 0 else { return false }
+        let length = vDSP_Length(values.count)
+        var count = Int32(values.count)
+
+        var maxLogit: Float = 0
+        vDSP_maxv(base, 1, &maxLogit, length)
+        var sum: Float = 0
+        if maxLogit.isFinite {
+            var shift = -maxLogit
+            vDSP_vsadd(base, 1, &shift, base, 1, length)
+            vvexpf(base, base, &count)
+            vDSP_sve(base, 1, &sum, length)
+        }
+        guard sum > 0, sum.isFinite else {
+            values.update(repeating: 1 / Float(values.count))
+            return false
+        }
+        vDSP_vsdiv(base, 1, &sum, base, 1, length)
+        return true
+    }
+}
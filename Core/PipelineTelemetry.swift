@@ -0,0 +1,320 @@
+import Foundation
+import QuartzCore
+import os
+
+/// Time slices of a rolling window (mirrors `RollingWindow` in `example_/PipelineTelemetry.h`)
+/// - The window is cut into `slices` slices stored in a ring of rows; a row is recycled once the
+///   clock moves past the slice it held, so series forget old samples without allocating
+struct RollingWindow {
+    let slices: Int
+    let sliceLength: TimeInterval
+    private var current = Int.min  // Absolute number of the newest slice
+
+    init(window: TimeInterval, slices: Int = 10) {
+        self.slices = max(slices, 1)
+        self.sliceLength = max(window / Double(self.slices), 0.001)
+    }
+
+    var seconds: TimeInterval { sliceLength * Double(slices) }
+
+    /// Row of `now`'s slice; `evict` gets every row whose slice left the window
+    mutating func advance(to now: TimeInterval, evict: (Int) -> Void) -> Int {
+        let slice = Int((now / sliceLength).rounded(.down))
+        if slice > current {
+            let first = current == Int.min ? slice - slices + 1 : max(current + 1, slice - slices + 1)
+            for s in first...slice {
+                evict(row(of: s))
+            }
+            current = slice
+        }
+        return row(of: current)
+    }
+
+    private func row(of slice: Int) -> Int {
+        ((slice % slices) + slices) % slices
+    }
+}
+
+/// Histogram of the samples of the last `window` seconds in fixed buckets
+/// (mirrors `RollingHistogram` in `example_/PipelineTelemetry.h`)
+/// - Logarithmic buckets for latencies, so a percentile is within one bucket's ratio of the exact value;
+///   linear buckets hold the integers 0...maxValue exactly, for queue depths
+/// - `record` is O(1) and a percentile is one pass over the buckets
+struct RollingHistogram {
+
+    // MARK: - Properties
+
+    private var window: RollingWindow
+    private let bucketCount: Int
+    private let low: Double
+    private let logRatio: Double  // 0 for linear buckets
+    private var counts: [UInt32]  // Row-major: counts[row * bucketCount + bucket]
+    private var totals: [Int]     // Per bucket, over every live row
+    private var rowCounts: [Int]
+    private var rowSums: [Double]
+    private var rowMax: [Double]
+    private var sum = 0.0
+    private(set) var count = 0
+
+    // MARK: - Initialization
+
+    private init(window: TimeInterval, bucketCount: Int, low: Double, logRatio: Double) {
+        self.window = RollingWindow(window: window)
+        self.bucketCount = bucketCount
+        self.low = low
+        self.logRatio = logRatio
+        let rows = self.window.slices
+        counts = Array(repeating: 0, count: rows * bucketCount)
+        totals = Array(repeating: 0, count: bucketCount)
+        rowCounts = Array(repeating: 0, count: rows)
+        rowSums = Array(repeating: 0, count: rows)
+        rowMax = Array(repeating: 0, count: rows)
+    }
+
+    static func logarithmic(low: Double, high: Double, bucketsPerOctave: Int, window: TimeInterval = 10) -> RollingHistogram {
+        let perOctave = max(bucketsPerOctave, 1)
+        let octaves = Int(log2(max(high / low, 2)).rounded(.up))
+        return RollingHistogram(window: window, bucketCount: octaves * perOctave + 2, low: low,
+                                logRatio: log(2.0) / Double(perOctave))
+    }
+
+    static func linear(maxValue: Int, window: TimeInterval = 10) -> RollingHistogram {
+        RollingHistogram(window: window, bucketCount: max(maxValue, 0) + 1, low: 0, logRatio: 0)
+    }
+
+    /// Frame latencies: 0.25 ms to about 16 s in quarter-octave (19%) buckets
+    static func latencyMs(window: TimeInterval = 10) -> RollingHistogram {
+        logarithmic(low: 0.25, high: 16000, bucketsPerOctave: 4, window: window)
+    }
+
+    // MARK: - Recording
+
+    mutating func record(_ value: Double, at now: TimeInterval) {
+        let row = advance(to: now)
+        let bucket = bucketIndex(of: max(value, 0))
+        counts[row * bucketCount + bucket] += 1
+        totals[bucket] += 1
+        rowCounts[row] += 1
+        rowSums[row] += value
+        rowMax[row] = max(rowMax[row], value)
+        count += 1
+        sum += value
+    }
+
+    /// Forget samples that left the window; reads reflect the window as of the last advance or record
+    @discardableResult
+    mutating func advance(to now: TimeInterval) -> Int {
+        var slices = window
+        let row = slices.advance(to: now) { evict($0) }
+        window = slices
+        return row
+    }
+
+    // MARK: - Reading
+
+    /// Nearest-rank percentile, p in 0...100, at bucket resolution and never above `max`; 0 when empty
+    func percentile(_ p: Double) -> Double {
+        guard count > 0 else { return 0 }
+        let rank = max(Int((min(max(p, 0), 100) / 100 * Double(count)).rounded(.up)), 1)
+        var seen = 0
+        for bucket in 0..<bucketCount {
+            seen += totals[bucket]
+            if seen >= rank {
+                return min(bucketValue(bucket), maxValue)
+            }
+        }
+        return maxValue
+    }
+
+    var mean: Double { count > 0 ? sum / Double(count) : 0 }
+    var maxValue: Double { rowMax.max() ?? 0 }
+    var windowSeconds: TimeInterval { window.seconds }
+
+    // MARK: - Private Methods
+
+    private func bucketIndex(of value: Double) -> Int {
+        if logRatio == 0 {
+            return Int(min(value, Double(bucketCount - 1)))
+        }
+        guard value >= low else { return 0 }
+        return min(Int((log(value / low) / logRatio).rounded(.down)) + 1, bucketCount - 1)
+    }
+
+    /// Upper edge of a logarithmic bucket, the value itself for linear ones
+    private func bucketValue(_ bucket: Int) -> Double {
+        logRatio == 0 ? Double(bucket) : low * exp(logRatio * Double(bucket))
+    }
+
+    private mutating func evict(_ row: Int) {
+        for bucket in 0..<bucketCount {
+            totals[bucket] -= Int(counts[row * bucketCount + bucket])
+            counts[row * bucketCount + bucket] = 0
+        }
+        count -= rowCounts[row]
+        sum -= rowSums[row]
+        rowCounts[row] = 0
+        rowSums[row] = 0
+        rowMax[row] = 0
+        if count == 0 {
+            sum = 0  // Drop accumulated rounding error
+        }
+    }
+}
+
+/// Event count over the last `window` seconds (mirrors `RollingCounter` in `example_/PipelineTelemetry.h`)
+struct RollingCounter {
+    private var window: RollingWindow
+    private var rowCounts: [Int]
+    private(set) var count = 0
+
+    init(window: TimeInterval = 10) {
+        self.window = RollingWindow(window: window)
+        rowCounts = Array(repeating: 0, count: self.window.slices)
+    }
+
+    mutating func add(_ n: Int = 1, at now: TimeInterval) {
+        let row = advance(to: now)
+        rowCounts[row] += n
+        count += n
+    }
+
+    @discardableResult
+    mutating func advance(to now: TimeInterval) -> Int {
+        var slices = window
+        let row = slices.advance(to: now) { row in
+            count -= rowCounts[row]
+            rowCounts[row] = 0
+        }
+        window = slices
+        return row
+    }
+}
+
+/// Rolling end-to-end latency and per-stage frame drops and queue depth of the camera → inference → UI path
+/// (the iOS side of `example_/PipelineTelemetry.h`)
+/// - Times are host time in seconds (`CACurrentMediaTime`, `ARFrame.timestamp`); every face carries its
+///   frame's capture time from `DetectedFace` through `FacePrediction`
+/// - Glass-to-glass ends at the display link's target timestamp, i.e. when the frame showing the
+///   prediction reaches the screen
+/// - Drops: `capture` frames the pipelines discard while Vision is busy, `inference` frames the rate
+///   controller skips, `display` snapshots replaced before a display tick took them
+/// - Depth: frames queued on the inference queue behind an inference frame (`FrameBacklog`)
+/// - Thread-safe; recorded from the capture queues and the main thread
+final class PipelineTelemetry: @unchecked Sendable {
+
+    // MARK: - Types
+
+    enum Stage: String, CaseIterable {
+        case capture, inference, display
+    }
+
+    struct LatencySummary: CustomStringConvertible {
+        var frames = 0
+        var p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0  // Milliseconds
+
+        var description: String {
+            String(format: "p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms over %d frames", p50, p95, p99, max, frames)
+        }
+    }
+
+    struct StageSummary: CustomStringConvertible {
+        let stage: Stage
+        var dropped = 0
+        var depthSamples = 0  // 0 for stages without a queue
+        var meanDepth = 0.0
+        var maxDepth = 0.0
+
+        var description: String {
+            let depth = depthSamples > 0 ? String(format: ", depth mean %.1f max %.0f", meanDepth, maxDepth) : ""
+            return "\(stage.rawValue) dropped \(dropped)\(depth)"
+        }
+    }
+
+    struct Snapshot: CustomStringConvertible {
+        var windowSeconds: TimeInterval = 0
+        var glassToGlass = LatencySummary()  // Capture to prediction on screen
+        var inference = LatencySummary()     // Capture to inference done
+        var stages: [StageSummary] = []
+
+        var description: String {
+            let stageText = stages.map(\.description).joined(separator: "; ")
+            return String(format: "last %.0f s: ", windowSeconds)
+                + "glass-to-glass \(glassToGlass); inference \(inference); \(stageText)"
+        }
+    }
+
+    private struct Series {
+        var glassToGlass: RollingHistogram
+        var inference: RollingHistogram
+        var dropped: [Stage: RollingCounter]
+        var depth: [Stage: RollingHistogram]
+    }
+
+    // MARK: - Properties
+
+    static let shared = PipelineTelemetry()
+
+    private let series: OSAllocatedUnfairLock<Series>
+
+    // MARK: - Initialization
+
+    init(window: TimeInterval = 10, maxQueueDepth: Int = 8) {
+        let initial = Series(
+            glassToGlass: .latencyMs(window: window),
+            inference: .latencyMs(window: window),
+            dropped: Dictionary(uniqueKeysWithValues: Stage.allCases.map { ($0, RollingCounter(window: window)) }),
+            depth: [.inference: .linear(maxValue: maxQueueDepth, window: window)]
+        )
+        series = OSAllocatedUnfairLock(initialState: initial)
+    }
+
+    // MARK: - Recording
+
+    func recordDrop(_ stage: Stage, at now: TimeInterval = CACurrentMediaTime()) {
+        series.withLock { $0.dropped[stage]?.add(at: now) }
+    }
+
+    /// Queue depth a stage saw when it took a frame; ignored for stages without a queue
+    func recordDepth(_ stage: Stage, _ depth: Int, at now: TimeInterval = CACurrentMediaTime()) {
+        series.withLock { $0.depth[stage]?.record(Double(depth), at: now) }
+    }
+
+    func recordInference(captureTime: TimeInterval, at now: TimeInterval = CACurrentMediaTime()) {
+        series.withLock { $0.inference.record((now - captureTime) * 1000, at: now) }
+    }
+
+    func recordDisplay(captureTime: TimeInterval, displayTime: TimeInterval) {
+        series.withLock { $0.glassToGlass.record((displayTime - captureTime) * 1000, at: displayTime) }
+    }
+
+    // MARK: - Reading
+
+    func snapshot(at now: TimeInterval = CACurrentMediaTime()) -> Snapshot {
+        series.withLock { series in
+            series.glassToGlass.advance(to: now)
+            series.inference.advance(to: now)
+            var snapshot = Snapshot(windowSeconds: series.glassToGlass.windowSeconds,
+                                    glassToGlass: Self.summarize(series.glassToGlass),
+                                    inference: Self.summarize(series.inference))
+            for stage in Stage.allCases {
+                var summary = StageSummary(stage: stage)
+                series.dropped[stage]?.advance(to: now)
+                summary.dropped = series.dropped[stage]?.count ?? 0
+                if var depth = series.depth[stage] {
+                    depth.advance(to: now)
+                    series.depth[stage] = depth
+                    summary.depthSamples = depth.count
+                    summary.meanDepth = depth.mean
+                    summary.maxDepth = depth.maxValue
+                }
+                snapshot.stages.append(summary)
+            }
+            return snapshot
+        }
+    }
+
+    private static func summarize(_ histogram: RollingHistogram) -> LatencySummary {
+        LatencySummary(frames: histogram.count, p50: histogram.percentile(50), p95: histogram.percentile(95),
+                       p99: histogram.percentile(99), max: histogram.maxValue)
+    }
+}
@@ -0,0 +1,73 @@
+import Foundation
+import QuartzCore
+
+/// Everything the UI shows from one inference frame
+struct PredictionSnapshot {
+    var faces: [FacePrediction] = []
+    var detectedFaces: [DetectedFace] = []  // Every face the pipeline found, predicted or not
+    var history: [[Float]] = []
+    var historyVersion = 0  // Bumped on every history append, so unchanged history is not re-sent
+}
+
+/// Hands the newest predictions to SwiftUI once per display refresh instead of once per frame
+/// - `publish(_:)` is wait-free (a `TripleBuffer` exchange), so the inference side never blocks
+///   and never queues a main-thread block
+/// - A display link capped at `maxFramesPerSecond` takes the newest snapshot and delivers it;
+///   ticks with nothing new cost one atomic load and touch no published state
+/// - Snapshots published between two ticks are coalesced
+final class PredictionPublisher: @unchecked Sendable {
+
+    // MARK: - Properties
+
+    private let buffer = TripleBuffer(PredictionSnapshot())
+    private var displayLink: CADisplayLink?
+    private(set) var deliveredCount = 0  // Main thread only
+    /// When the frame drawn from the delivered snapshot reaches the screen (host time, main thread only)
+    private(set) var targetTimestamp: CFTimeInterval = 0
+
+    let maxFramesPerSecond: Float
+
+    // MARK: - Initialization
+
+    init(maxFramesPerSecond: Float = 15) {
+        self.maxFramesPerSecond = maxFramesPerSecond
+    }
+
+    deinit {
+        displayLink?.invalidate()
+    }
+
+    /// Start delivering snapshots to `deliver` on the main thread
+    func start(_ deliver: @escaping @MainActor (PredictionSnapshot) -> Void) {
+        guard displayLink == nil else { return }
+        let link = CADisplayLink(target: DisplayLinkTarget { [weak self] in
+                                     guard let self = self, self.buffer.update() else { return }
+                                     self.deliveredCount += 1
+                                     self.targetTimestamp = self.displayLink?.targetTimestamp ?? CACurrentMediaTime()
+                                     deliver(self.buffer.latest)
+                                 },
+                                 selector: #selector(DisplayLinkTarget.fire))
+        link.preferredFrameRateRange = CAFrameRateRange(minimum: 1, maximum: maxFramesPerSecond,
+                                                        preferred: maxFramesPerSecond)
+        link.add(to: .main, forMode: .common)
+        displayLink = link
+    }
+
+    // MARK: - Producer
+
+    /// Replace the snapshot the next display tick delivers; true when that drops one no tick took yet
+    @discardableResult
+    func publish(_ snapshot: PredictionSnapshot) -> Bool {
+        let replaced = buffer.hasPending
+        buffer.publish(snapshot)
+        return replaced
+    }
+
+    // MARK: - Lifecycle
+
+    /// Stop or resume display ticks (main thread); a snapshot published meanwhile is kept
+    var isPaused: Bool {
+        get { displayLink?.isPaused ?? true }
+        set { displayLink?.isPaused = newValue }
+    }
+}
@@ -0,0 +1,67 @@
+import Foundation
+
+// MARK: - Probability History Ring Buffer
+/// Fixed-capacity probability history in structure-of-arrays layout (mirrors `example_/ProbabilityHistory.h`).
+/// One flat `classCount × capacity` buffer holds every sample, with class `c` in row `c`.
+/// `push` is O(1) and overwrites the oldest frame once full; frame 0 is the oldest.
+struct ProbabilityHistory {
+    private var samples: [Float]
+    private var oldest = 0
+    private(set) var count = 0
+    let classCount: Int
+    let capacity: Int
+
+    init(classCount: Int, capacity: Int) {
+        self.classCount = classCount
+        self.capacity = max(1, capacity)
+        self.samples = [Float](repeating: 0, count: classCount * self.capacity)
+    }
+
+    var isEmpty: Bool { count == 0 }
+
+    /// Append one frame of `classCount` probabilities
+    mutating func push(_ frame: [Float]) {
+        let slot: Int
+        if count < capacity {
+            slot = (oldest + count) % capacity
+            count += 1
+        } else {
+            slot = oldest
+            oldest = (oldest + 1) % capacity
+        }
+        for c in 0..<min(classCount, frame.count) {
+            samples[c * capacity + slot] = frame[c]
+        }
+    }
+
+    func value(frame index: Int, classIndex: Int) -> Float {
+        samples[classIndex * capacity + (oldest + index) % capacity]
+    }
+
+    /// Gather one frame across classes (allocates; not meant for the per-frame path)
+    func frame(at index: Int) -> [Float] {
+        (0..<classCount).map { value(frame: index, classIndex: $0) }
+    }
+
+    /// A class's samples, oldest to newest, as at most two contiguous runs split at the wrap
+    func series(classIndex: Int) -> (older: ArraySlice<Float>, newer: ArraySlice<Float>) {
+        let row = classIndex * capacity
+        let firstRun = min(count, capacity - oldest)
+        return (samples[(row + oldest)..<(row + oldest + firstRun)],
+                samples[row..<(row + count - firstRun)])
+    }
+
+    mutating func reset() {
+        oldest = 0
+        count = 0
+    }
+
+    /// Copy of this history with a new capacity, keeping the newest frames that fit
+    func resized(capacity newCapacity: Int) -> ProbabilityHistory {
+        var resized = ProbabilityHistory(classCount: classCount, capacity: newCapacity)
+        for index in max(0, count - resized.capacity)..<count {
+            resized.push(frame(at: index))
+        }
+        return resized
+    }
+}
@@ -0,0 +1,183 @@
+import Foundation
+
+// MARK: - Sliding Window Median
+/// Running median over the last `window` values, updated in O(log W) per push.
+/// Port of `example_/RunningMedian.h`: window values live in a ring of slots and two
+/// indexed heaps hold the lower/upper halves, so the oldest value is replaced in place.
+/// The median is the element at index `count / 2` of the sorted window.
+final class SlidingMedian {
+    private var values: [Float]
+    private var positions: [Int]
+    private var inLower: [Bool]
+    private var lower = IndexedHeap(isMax: true)   // smaller half, count / 2 entries
+    private var upper = IndexedHeap(isMax: false)  // larger half, top is the median
+    private var oldest = 0
+    private(set) var count = 0
+    let window: Int
+
+    init(window: Int) {
+        self.window = max(1, window)
+        values = [Float](repeating: 0, count: self.window)
+        positions = [Int](repeating: 0, count: self.window)
+        inLower = [Bool](repeating: false, count: self.window)
+        lower.slots.reserveCapacity(self.window)
+        upper.slots.reserveCapacity(self.window)
+    }
+
+    /// Median of the current window, nil until the first push
+    var median: Float? {
+        upper.slots.first.map { values[$0] }
+    }
+
+    /// Add a value, evicting the oldest one once the window is full
+    func push(_ value: Float) {
+        if count < window {
+            let slot = (oldest + count) % window
+            values[slot] = value
+            count += 1
+            let belowMedian = upper.slots.first.map { value < values[$0] } ?? false
+            insert(slot, intoLower: belowMedian)
+            rebalance()
+            return
+        }
+
+        // Window full: overwrite the oldest slot and restore heap order
+        let slot = oldest
+        oldest = (oldest + 1) % window
+        values[slot] = value
+        if inLower[slot] {
+            lower.siftUp(from: positions[slot], values: values, positions: &positions)
+            lower.siftDown(from: positions[slot], values: values, positions: &positions)
+        } else {
+            upper.siftUp(from: positions[slot], values: values, positions: &positions)
+            upper.siftDown(from: positions[slot], values: values, positions: &positions)
+        }
+
+        if let lowTop = lower.slots.first, let highTop = upper.slots.first, values[lowTop] > values[highTop] {
+            lower.place(highTop, at: 0, positions: &positions)
+            upper.place(lowTop, at: 0, positions: &positions)
+            inLower[lowTop] = false
+            inLower[highTop] = true
+            lower.siftDown(from: 0, values: values, positions: &positions)
+            upper.siftDown(from: 0, values: values, positions: &positions)
+        }
+    }
+
+    func reset() {
+        lower.slots.removeAll(keepingCapacity: true)
+        upper.slots.removeAll(keepingCapacity: true)
+        oldest = 0
+        count = 0
+    }
+
+    // MARK: - Private
+
+    private func insert(_ slot: Int, intoLower: Bool) {
+        inLower[slot] = intoLower
+        if intoLower {
+            lower.push(slot, values: values, positions: &positions)
+        } else {
+            upper.push(slot, values: values, positions: &positions)
+        }
+    }
+
+    private func rebalance() {
+        if lower.slots.count > count / 2 {
+            insert(lower.pop(values: values, positions: &positions), intoLower: false)
+        }
+        if upper.slots.count > count - count / 2 {
+            insert(upper.pop(values: values, positions: &positions), intoLower: true)
+        }
+    }
+}
+
+/// Binary heap of slot ids ordered by the slot's value
+private struct IndexedHeap {
+    var slots: [Int] = []
+    let isMax: Bool
+
+    init(isMax: Bool) {
+        self.isMax = isMax
+    }
+
+    private func above(_ a: Int, _ b: Int, _ values: [Float]) -> Bool {
+        isMax ? values[a] > values[b] : values[a] < values[b]
+    }
+
+    mutating func place(_ slot: Int, at index: Int, positions: inout [Int]) {
+        slots[index] = slot
+        positions[slot] = index
+    }
+
+    mutating func siftUp(from start: Int, values: [Float], positions: inout [Int]) {
+        var i = start
+        let slot = slots[i]
+        while i > 0 {
+            let parent = (i - 1) / 2
+            guard above(slot, slots[parent], values) else { break }
+            place(slots[parent], at: i, positions: &positions)
+            i = parent
+        }
+        place(slot, at: i, positions: &positions)
+    }
+
+    mutating func siftDown(from start: Int, values: [Float], positions: inout [Int]) {
+        var i = start
+        let slot = slots[i]
+        let n = slots.count
+        while true {
+            var child = 2 * i + 1
+            guard child < n else { break }
+            if child + 1 < n && above(slots[child + 1], slots[child], values) {
+                child += 1
+            }
+            guard above(slots[child], slot, values) else { break }
+            place(slots[child], at: i, positions: &positions)
+            i = child
+        }
+        place(slot, at: i, positions: &positions)
+    }
+
+    mutating func push(_ slot: Int, values: [Float], positions: inout [Int]) {
+        slots.append(slot)
+        siftUp(from: slots.count - 1, values: values, positions: &positions)
+    }
+
+    mutating func pop(values: [Float], positions: inout [Int]) -> Int {
+        let top = slots[0]
+        let last = slots.removeLast()
+        if !slots.isEmpty {
+            place(last, at: 0, positions: &positions)
+            siftDown(from: 0, values: values, positions: &positions)
+        }
+        return top
+    }
+}
+
+// MARK: - Per-Class Running Median
+/// One sliding median per emotion class over the last `window` frames
+final class RunningMedian {
+    private let perClass: [SlidingMedian]
+
+    init(classCount: Int, window: Int) {
+        perClass = (0..<classCount).map { _ in SlidingMedian(window: window) }
+    }
+
+    var count: Int { perClass.first?.count ?? 0 }
+
+    func push(_ frame: [Float]) {
+        for (c, median) in perClass.enumerated() where c < frame.count {
+            median.push(frame[c])
+        }
+    }
+
+    /// Per-class medians, nil until the first push
+    func medians() -> [Float]? {
+        guard count > 0 else { return nil }
+        return perClass.map { $0.median ?? 0 }
+    }
+
+    func reset() {
+        perClass.forEach { $0.reset() }
+    }
+}
@@ -0,0 +1,146 @@
+import Foundation
+
+/// Appends each inferred face to a binary session recording (same format as
+/// `example_/SessionRecording.h`, replayable with `example_/replay.cpp`)
+/// - 64-byte header, then one fixed-size record per face: timestamp, frame index, track ID,
+///   bounding box (Vision's normalized coordinates) and raw + smoothed probabilities
+/// - Records are encoded into a buffer allocated once and written with `write(2)` when it
+///   fills, so recording does not allocate per frame
+/// - Enabled by launching with the `FER_RECORD_SESSION` environment variable; the file goes to
+///   the app's Documents directory
+final class SessionRecorder {
+
+    // MARK: - Format
+
+    private static let magic: UInt32 = 0x53524546  // "FERS"
+    private static let version: UInt16 = 1
+    private static let float16Flag: UInt16 = 1 << 0
+    private static let normalizedRectsFlag: UInt16 = 1 << 1
+    private static let headerSize = 64
+    private static let fixedRecordBytes = 32
+
+    // MARK: - Properties
+
+    let url: URL
+    let numClasses: Int
+    let usesFloat16: Bool
+    private(set) var recordCount = 0
+
+    private let descriptor: Int32
+    private let recordSize: Int
+    private let buffer: UnsafeMutableRawBufferPointer
+    private var buffered = 0
+    private let start = DispatchTime.now().uptimeNanoseconds
+
+    // MARK: - Initialization
+
+    init?(url: URL, numClasses: Int = emotionClasses.count, float16: Bool = false, bufferRecords: Int = 4096) {
+        let recordSize = (Self.fixedRecordBytes + 2 * numClasses * (float16 ? 2 : 4) + 7) & ~7
+        let descriptor = open(url.path, O_WRONLY | O_CREAT | O_TRUNC, 0o644)
+        guard descriptor >= 0 else {
+            Log.error("[SessionRecorder] Cannot open \(url.path): errno \(errno)")
+            return nil
+        }
+        self.url = url
+        self.numClasses = numClasses
+        self.usesFloat16 = float16
+        self.descriptor = descriptor
+        self.recordSize = recordSize
+        self.buffer = .allocate(byteCount: max(bufferRecords, 1) * recordSize + Self.headerSize,
+                                alignment: MemoryLayout<UInt64>.alignment)
+        buffer.initializeMemory(as: UInt8.self, repeating: 0)
+
+        // Header: magic, version, flags, numClasses, recordSize, reserved, wall-clock start (ns)
+        let flags = Self.normalizedRectsFlag | (float16 ? Self.float16Flag : 0)
+        let wallClock = UInt64(Date().timeIntervalSince1970 * 1e9)
+        buffer.storeBytes(of: Self.magic.littleEndian, toByteOffset: 0, as: UInt32.self)
+        buffer.storeBytes(of: Self.version.littleEndian, toByteOffset: 4, as: UInt16.self)
+        buffer.storeBytes(of: flags.littleEndian, toByteOffset: 6, as: UInt16.self)
+        buffer.storeBytes(of: UInt16(numClasses).littleEndian, toByteOffset: 8, as: UInt16.self)
+        buffer.storeBytes(of: UInt16(recordSize).littleEndian, toByteOffset: 10, as: UInt16.self)
+        buffer.storeBytes(of: wallClock.littleEndian, toByteOffset: 16, as: UInt64.self)
+        buffered = Self.headerSize
+
+        Log.info("[SessionRecorder] Recording to \(url.lastPathComponent)")
+    }
+
+    /// Recorder requested through the `FER_RECORD_SESSION` environment variable, if any
+    static func fromEnvironment() -> SessionRecorder? {
+        guard ProcessInfo.processInfo.environment["FER_RECORD_SESSION"] != nil,
+              let documents = FileManager.default.urls(for: .documentDirectory, in: .userDomainMask).first else {
+            return nil
+        }
+        let formatter = DateFormatter()
+        formatter.dateFormat = "yyyyMMdd-HHmmss"
+        return SessionRecorder(url: documents.appendingPathComponent("session-\(formatter.string(from: Date())).fers"))
+    }
+
+    deinit {
+        close()
+        buffer.deallocate()
+    }
+
+    // MARK: - Recording
+
+    /// Append one face; `raw` and `smoothed` hold `numClasses` probabilities (missing ones are 0)
+    func append(frameIndex: Int, trackID: Int, boundingBox: CGRect, raw: [Float], smoothed: [Float]) {
+        if buffered + recordSize > buffer.count {
+            flush()
+        }
+
+        let offset = buffered
+        let timestamp = DispatchTime.now().uptimeNanoseconds - start
+        buffer.storeBytes(of: timestamp.littleEndian, toByteOffset: offset, as: UInt64.self)
+        buffer.storeBytes(of: UInt32(truncatingIfNeeded: frameIndex).littleEndian, toByteOffset: offset + 8, as: UInt32.self)
+        buffer.storeBytes(of: UInt32(truncatingIfNeeded: trackID).littleEndian, toByteOffset: offset + 12, as: UInt32.self)
+        store(boundingBox.minX, at: offset + 16)
+        store(boundingBox.minY, at: offset + 20)
+        store(boundingBox.width, at: offset + 24)
+        store(boundingBox.height, at: offset + 28)
+        let probabilityBytes = numClasses * (usesFloat16 ? 2 : 4)
+        store(raw, at: offset + Self.fixedRecordBytes)
+        store(smoothed, at: offset + Self.fixedRecordBytes + probabilityBytes)
+
+        buffered += recordSize
+        recordCount += 1
+    }
+
+    /// Write buffered records to the file, e.g. before the app is suspended
+    func flush() {
+        guard buffered > 0, let base = buffer.baseAddress else { return }
+        var written = 0
+        while written < buffered {
+            let result = write(descriptor, base + written, buffered - written)
+            if result < 0 {
+                if errno == EINTR { continue }
+                Log.error("[SessionRecorder] Write failed: errno \(errno)")
+                break
+            }
+            written += result
+        }
+        buffered = 0
+    }
+
+    // MARK: - Private Methods
+
+    private func store(_ value: CGFloat, at offset: Int) {
+        buffer.storeBytes(of: Float(value).bitPattern.littleEndian, toByteOffset: offset, as: UInt32.self)
+    }
+
+    private func store(_ values: [Float], at offset: Int) {
+        for index in 0..<numClasses {
+            let value = index < values.count ? values[index] : 0
+            if usesFloat16 {
+                buffer.storeBytes(of: Float16(value).bitPattern.littleEndian, toByteOffset: offset + index * 2, as: UInt16.self)
+            } else {
+                buffer.storeBytes(of: value.bitPattern.littleEndian, toByteOffset: offset + index * 4, as: UInt32.self)
+            }
+        }
+    }
+
+    private func close() {
+        flush()
+        Darwin.close(descriptor)
+        Log.info("[SessionRecorder] Recorded \(recordCount) faces to \(url.lastPathComponent)")
+    }
+}
@@ -0,0 +1,133 @@
+import Foundation
+import CoreGraphics
+
+// MARK: - Smoother Pool
+/// Fixed pool of `TemporalSmoother`s keyed by a lightweight IoU face track ID
+/// (mirrors `example_/SmootherPool.h`).
+/// Detections are matched to live tracks by greedy highest-IoU pairing, so a face keeps its
+/// smoothing state when Vision reorders its results. Unmatched detections start a new track in
+/// a free slot; tracks unseen for more than `maxMissedFrames` are released and their smoother
+/// is reset and reused, so no smoother is ever allocated after init.
+final class SmootherPool {
+    private struct Track {
+        let smoother: TemporalSmoother
+        var box: CGRect = .zero
+        var id: Int = 0
+        var lastSeen: Int = 0
+        var isActive = false
+    }
+
+    private struct Candidate {
+        let iou: CGFloat
+        let detection: Int
+        let slot: Int
+    }
+
+    private var tracks: [Track]
+    private var matched: [Bool]
+    private var candidates: [Candidate] = []
+    private let minIoU: CGFloat
+    private let maxMissedFrames: Int
+    private var frameIndex = 0
+    private var nextID = 1
+
+    var capacity: Int { tracks.count }
+    var activeCount: Int { tracks.filter(\.isActive).count }
+
+    init(capacity: Int, settings: InferenceSettings, minIoU: CGFloat = 0.3, maxMissedFrames: Int = 5) {
+        tracks = (0..<max(1, capacity)).map { _ in Track(smoother: TemporalSmoother(settings: settings)) }
+        matched = [Bool](repeating: false, count: tracks.count)
+        candidates.reserveCapacity(tracks.count * tracks.count)
+        self.minIoU = minIoU
+        self.maxMissedFrames = maxMissedFrames
+    }
+
+    /// Match this frame's boxes to tracks; returns the slot for each box (nil when the pool is exhausted).
+    /// Only the first `capacity` boxes are considered.
+    func assign(_ boxes: [CGRect]) -> [Int?] {
+        frameIndex += 1
+        var slots = [Int?](repeating: nil, count: boxes.count)
+        let count = min(boxes.count, tracks.count)
+        for s in matched.indices { matched[s] = false }
+
+        candidates.removeAll(keepingCapacity: true)
+        for d in 0..<count {
+            for s in tracks.indices where tracks[s].isActive {
+                let iou = boxes[d].intersectionOverUnion(with: tracks[s].box)
+                if iou >= minIoU {
+                    candidates.append(Candidate(iou: iou, detection: d, slot: s))
+                }
+            }
+        }
+        candidates.sort { a, b in
+            if a.iou != b.iou { return a.iou > b.iou }
+            return a.detection != b.detection ? a.detection < b.detection : a.slot < b.slot
+        }
+        for candidate in candidates where slots[candidate.detection] == nil && !matched[candidate.slot] {
+            slots[candidate.detection] = candidate.slot
+            matched[candidate.slot] = true
+        }
+
+        for d in 0..<count {
+            if slots[d] == nil, let slot = claimSlot() {
+                tracks[slot].id = nextID
+                tracks[slot].isActive = true
+                tracks[slot].smoother.reset()
+                nextID += 1
+                slots[d] = slot
+                matched[slot] = true
+            }
+            guard let slot = slots[d] else { continue }
+            tracks[slot].box = boxes[d]
+            tracks[slot].lastSeen = frameIndex
+        }
+
+        for s in tracks.indices where tracks[s].isActive && frameIndex - tracks[s].lastSeen > maxMissedFrames {
+            tracks[s].isActive = false
+        }
+        return slots
+    }
+
+    func smoother(at slot: Int) -> TemporalSmoother {
+        tracks[slot].smoother
+    }
+
+    func trackID(at slot: Int) -> Int {
+        tracks[slot].id
+    }
+
+    /// Drop every track and reset each smoother to the given settings
+    func reset(settings: InferenceSettings? = nil) {
+        for s in tracks.indices {
+            tracks[s].isActive = false
+            if let settings = settings {
+                tracks[s].smoother.update(settings: settings)
+            }
+            tracks[s].smoother.reset()
+        }
+    }
+
+    // MARK: - Private
+
+    /// A free slot, or the stalest track not matched this frame when the pool is full
+    private func claimSlot() -> Int? {
+        var stalest: Int?
+        for s in tracks.indices {
+            if !tracks[s].isActive { return s }
+            if !matched[s], tracks[s].lastSeen < (stalest.map { tracks[$0].lastSeen } ?? .max) {
+                stalest = s
+            }
+        }
+        return stalest
+    }
+}
+
+extension CGRect {
+    func intersectionOverUnion(with other: CGRect) -> CGFloat {
+        let inter = intersection(other)
+        guard !inter.isNull else { return 0 }
+        let interArea = inter.width * inter.height
+        let unionArea = width * height + other.width * other.height - interArea
+        return unionArea > 0 ? interArea / unionArea : 0
+    }
+}
@@ -1,18 +1,33 @@
 import Foundation
 
 // MARK: - Temporal Smoothing
+/// Neutral boost → EMA → history ring → running median, driven by `InferenceSettings`.
+/// The desktop `SmoothingPipeline` (example_/SmoothingPipeline.h) runs the same chain with
+/// the same parameters, so both paths produce the same smoothed output.
 class TemporalSmoother {
     private var emaState: [Float] = []
-    private var history: [[Float]] = []
+    private var history: ProbabilityHistory
     private var settings: InferenceSettings
+    private var runningMedian: RunningMedian
     private let neutralIndex = 3 // neutral is index 3 in the correct class order
     
     init(settings: InferenceSettings) {
         self.settings = settings
+        self.history = ProbabilityHistory(classCount: emotionClasses.count, capacity: settings.ringBufferSize)
+        self.runningMedian = RunningMedian(classCount: emotionClasses.count, window: Self.medianWindow(for: settings))
     }
     
     func update(settings: InferenceSettings) {
         self.settings = settings
+        if history.capacity != settings.ringBufferSize {
+            history = history.resized(capacity: settings.ringBufferSize)
+        }
+        // Rebuild the median for the new window and replay the frames it should cover
+        let window = Self.medianWindow(for: settings)
+        runningMedian = RunningMedian(classCount: emotionClasses.count, window: window)
+        for index in max(0, history.count - window)..<history.count {
+            runningMedian.push(history.frame(at: index))
+        }
     }
     
     func smooth(_ probabilities: [Float]) -> [Float] {
@@ -35,39 +50,26 @@ class TemporalSmoother {
             }
         }
         
-        // Add to history with configurable ring buffer size
-        history.append(emaState)
-        if history.count > settings.ringBufferSize {
-            history.removeFirst()
-        }
+        // Add to history ring (capacity = ringBufferSize, O(1) eviction)
+        history.push(emaState)
+        runningMedian.push(emaState)
         
         return medianFromRecentFrames()
     }
     
+    /// Median of the last `framesForAverage` frames (capped by the ring buffer),
+    /// maintained incrementally by `RunningMedian` instead of re-sorting every frame
     private func medianFromRecentFrames() -> [Float] {
-        guard !history.isEmpty, let first = history.first else { return emaState }
-        let window = max(1, min(settings.framesForAverage, history.count))
-        let start = history.count - window
-        
-        var medians = [Float](repeating: 0, count: first.count)
-        
-        for c in 0..<first.count {
-            var values: [Float] = []
-            for i in start..<history.count {
-                if c < history[i].count {
-                    values.append(history[i][c])
-                }
-            }
-            values.sort()
-            if !values.isEmpty {
-                medians[c] = values[values.count / 2]
-            }
-        }
-        return medians
+        runningMedian.medians() ?? emaState
+    }
+    
+    private static func medianWindow(for settings: InferenceSettings) -> Int {
+        max(1, min(settings.framesForAverage, settings.ringBufferSize))
     }
     
     func reset() {
         emaState = []
-        history = []
+        history.reset()
+        runningMedian.reset()
     }
 }
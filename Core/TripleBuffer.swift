@@ -0,0 +1,56 @@
+import Foundation
+import Synchronization
+
+/// Wait-free single-writer / single-reader mailbox that always holds the newest value
+/// (mirrors `example_/TripleBuffer.h`)
+/// - The writer `publish`es into its own slot and trades it for the hand-over slot with one
+///   atomic exchange; the reader `update`s the same way, so neither side ever waits
+/// - Values published between two reads are coalesced; the reader only sees the newest
+/// - Exactly one writer thread and one reader thread
+final class TripleBuffer<Value>: @unchecked Sendable {
+
+    // MARK: - Properties
+
+    private static var indexMask: UInt8 { 0x3 }
+    private static var dirtyBit: UInt8 { 0x4 }
+
+    private let slots: UnsafeMutablePointer<Value>
+    private let middle = Atomic<UInt8>(1)  // Slot being handed over, plus dirtyBit
+    private var back: UInt8 = 0            // Owned by the writer
+    private var front: UInt8 = 2           // Owned by the reader
+
+    // MARK: - Initialization
+
+    init(_ initial: Value) {
+        slots = .allocate(capacity: 3)
+        slots.initialize(repeating: initial, count: 3)
+    }
+
+    deinit {
+        slots.deinitialize(count: 3)
+        slots.deallocate()
+    }
+
+    // MARK: - Writer
+
+    func publish(_ value: Value) {
+        slots[Int(back)] = value
+        back = middle.exchange(back | Self.dirtyBit, ordering: .acquiringAndReleasing) & Self.indexMask
+    }
+
+    /// Whether the last published value is still waiting for the reader; a hint only, the reader may
+    /// take it right after
+    var hasPending: Bool { middle.load(ordering: .relaxed) & Self.dirtyBit != 0 }
+
+    // MARK: - Reader
+
+    /// Take the newest published value; false when nothing new arrived since the last update
+    func update() -> Bool {
+        guard middle.load(ordering: .relaxed) & Self.dirtyBit != 0 else { return false }
+        front = middle.exchange(front, ordering: .acquiringAndReleasing) & Self.indexMask
+        return true
+    }
+
+    /// The value taken by the last successful `update`
+    var latest: Value { slots[Int(front)] }
+}
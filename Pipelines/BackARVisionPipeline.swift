@@ -11,9 +11,15 @@ class BackARVisionPipeline: NSObject, CameraPipeline {
         return "ARKit + LiDAR (back camera)"
     }
 
-    var onFrameCapture: ((CVPixelBuffer, [DetectedFace], CGImagePropertyOrientation) -> Void)?
-    var onDepthCapture: ((CVPixelBuffer) -> Void)?
-    var onFacesDetected: (([DetectedFace]) -> Void)?
+    private let callbacks = PipelineCallbacks()
+    var onFrameCapture: PipelineCallbacks.FrameHandler? {
+        get { callbacks.onFrameCapture }
+        set { callbacks.onFrameCapture = newValue }
+    }
+    var onDepthCapture: PipelineCallbacks.DepthHandler? {
+        get { callbacks.onDepthCapture }
+        set { callbacks.onDepthCapture = newValue }
+    }
 
     private(set) var arSession: ARSession?
     private let faceLandmarksRequest = VNDetectFaceLandmarksRequest()
@@ -191,6 +197,7 @@ extension BackARVisionPipeline: ARSessionDelegate {
         processingLock.lock()
         if isProcessing {
             processingLock.unlock()
+            PipelineTelemetry.shared.recordDrop(.capture)
             return
         }
         isProcessing = true
@@ -201,6 +208,7 @@ extension BackARVisionPipeline: ARSessionDelegate {
         let depthMap = (frame.smoothedSceneDepth ?? frame.sceneDepth)?.depthMap
         let camera = frame.camera
         let depthData = frame.smoothedSceneDepth ?? frame.sceneDepth
+        let captureTime = frame.timestamp
         
         // ARKit back camera is in landscape right orientation
         let orientation: CGImagePropertyOrientation = .right
@@ -231,7 +239,8 @@ extension BackARVisionPipeline: ARSessionDelegate {
                     roll: rollValue,
                     worldPosition: nil,  // nil when LiDAR off
                     transform: nil,  // nil when LiDAR off
-                    blendShapes: nil
+                    blendShapes: nil,
+                    captureTime: captureTime
                 )
             }
 
@@ -255,7 +264,8 @@ extension BackARVisionPipeline: ARSessionDelegate {
                 roll: rollValue,
                 worldPosition: result.worldPos,
                 transform: transform,
-                blendShapes: nil
+                blendShapes: nil,
+                captureTime: captureTime
             )
         }
 
@@ -264,14 +274,12 @@ extension BackARVisionPipeline: ARSessionDelegate {
         isProcessing = false
         processingLock.unlock()
 
-        // Dispatch only extracted data to main queue
-        DispatchQueue.main.async { [weak self] in
-            if let depthMap = depthMap {
-                self?.onDepthCapture?(depthMap)
-            }
-            self?.onFacesDetected?(faces)
-            self?.onFrameCapture?(pixelBuffer, faces, orientation)
+        // Hand over only extracted data, right here on the processing queue; the predictor
+        // queues inference itself and the UI reads results at display rate
+        if let depthMap = depthMap {
+            onDepthCapture?(depthMap)
         }
+        onFrameCapture?(pixelBuffer, faces, orientation)
     }
 
     func session(_ session: ARSession, didFailWithError error: Error) {
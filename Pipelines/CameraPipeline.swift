@@ -4,15 +4,17 @@ import CoreVideo
 import ImageIO
 import simd
 import ARKit
+import os
 
 protocol CameraPipeline: AnyObject {
     var id: String { get }
     var pipelineDescription: String { get }
     /// Callback with pixel buffer, detected faces, and the orientation used for Vision detection.
     /// The orientation should be applied to VNImageRequestHandler to ensure regionOfInterest aligns correctly.
+    /// Called on the pipeline's processing queue, never the main thread; set from any thread.
     var onFrameCapture: ((CVPixelBuffer, [DetectedFace], CGImagePropertyOrientation) -> Void)? { get set }
+    /// Called on the pipeline's processing queue, like `onFrameCapture`
     var onDepthCapture: ((CVPixelBuffer) -> Void)? { get set }
-    var onFacesDetected: (([DetectedFace]) -> Void)? { get set }
     var previewLayer: AVCaptureVideoPreviewLayer? { get }
     var arSession: ARSession? { get }
     
@@ -34,6 +36,8 @@ struct DetectedFace {
     let transform: simd_float4x4?
     /// Face geometry blend shapes (for detailed expression tracking)
     let blendShapes: [String: Float]?
+    /// Host time (`CACurrentMediaTime` clock) the camera captured the frame, for latency telemetry
+    let captureTime: TimeInterval?
     
     init(
         boundingBox: CGRect,
@@ -43,7 +47,8 @@ struct DetectedFace {
         roll: Float? = nil,
         worldPosition: SIMD3<Float>? = nil,
         transform: simd_float4x4? = nil,
-        blendShapes: [String: Float]? = nil
+        blendShapes: [String: Float]? = nil,
+        captureTime: TimeInterval? = nil
     ) {
         self.boundingBox = boundingBox
         self.depthMeters = depthMeters
@@ -53,6 +58,28 @@ struct DetectedFace {
         self.worldPosition = worldPosition
         self.transform = transform
         self.blendShapes = blendShapes
+        self.captureTime = captureTime
+    }
+}
+
+/// Frame callbacks of a pipeline: set by the coordinator on the main thread, called on the
+/// pipeline's processing queue, so every access goes through one lock
+final class PipelineCallbacks: @unchecked Sendable {
+    typealias FrameHandler = (CVPixelBuffer, [DetectedFace], CGImagePropertyOrientation) -> Void
+    typealias DepthHandler = (CVPixelBuffer) -> Void
+
+    private let lock = OSAllocatedUnfairLock()
+    private var frame: FrameHandler?
+    private var depth: DepthHandler?
+
+    var onFrameCapture: FrameHandler? {
+        get { lock.lock(); defer { lock.unlock() }; return frame }
+        set { lock.lock(); defer { lock.unlock() }; frame = newValue }
+    }
+
+    var onDepthCapture: DepthHandler? {
+        get { lock.lock(); defer { lock.unlock() }; return depth }
+        set { lock.lock(); defer { lock.unlock() }; depth = newValue }
     }
 }
 
@@ -11,9 +11,15 @@ class FrontVisionPipeline: NSObject, CameraPipeline {
         return usesARKit ? "ARKit Face Tracking (TrueDepth)" : "Vision (fallback)"
     }
 
-    var onFrameCapture: ((CVPixelBuffer, [DetectedFace], CGImagePropertyOrientation) -> Void)?
-    var onDepthCapture: ((CVPixelBuffer) -> Void)?
-    var onFacesDetected: (([DetectedFace]) -> Void)?
+    private let callbacks = PipelineCallbacks()
+    var onFrameCapture: PipelineCallbacks.FrameHandler? {
+        get { callbacks.onFrameCapture }
+        set { callbacks.onFrameCapture = newValue }
+    }
+    var onDepthCapture: PipelineCallbacks.DepthHandler? {
+        get { callbacks.onDepthCapture }
+        set { callbacks.onDepthCapture = newValue }
+    }
 
     // ARKit components
     private(set) var arSession: ARSession?
@@ -195,6 +201,8 @@ extension FrontVisionPipeline: ARSessionDelegate {
         processingLock.lock()
         if isProcessing {
             processingLock.unlock()
+            Trace.event("droppedFrame")
+            PipelineTelemetry.shared.recordDrop(.capture)
             return
         }
         isProcessing = true
@@ -203,6 +211,7 @@ extension FrontVisionPipeline: ARSessionDelegate {
         // CRITICAL: Extract all needed data from ARFrame IMMEDIATELY and synchronously
         // Copy pixel buffer (CVPixelBuffer is reference-counted separately)
         let pixelBuffer = frame.capturedImage
+        let captureTime = frame.timestamp
         
         // Extract face anchors immediately
         let faceAnchors = frame.anchors.compactMap { $0 as? ARFaceAnchor }
@@ -250,7 +259,8 @@ extension FrontVisionPipeline: ARSessionDelegate {
                     roll: roll,
                     worldPosition: position,
                     transform: transform,
-                    blendShapes: shapes
+                    blendShapes: shapes,
+                    captureTime: captureTime
                 )
             }
             
@@ -259,11 +269,9 @@ extension FrontVisionPipeline: ARSessionDelegate {
         isProcessing = false
         processingLock.unlock()
         
-        // Dispatch with extracted data (no frame references)
-        DispatchQueue.main.async { [weak self] in
-            self?.onFacesDetected?(faces)
-            self?.onFrameCapture?(pixelBuffer, faces, .up)
-        }
+        // Hand over extracted data (no frame references) right here on the processing queue;
+        // the predictor queues inference itself and the UI reads results at display rate
+        onFrameCapture?(pixelBuffer, faces, .up)
     }
 
     func session(_ session: ARSession, didFailWithError error: Error) {
@@ -322,6 +330,8 @@ extension FrontVisionPipeline: AVCaptureVideoDataOutputSampleBufferDelegate {
         processingLock.lock()
         if isProcessing {
             processingLock.unlock()
+            Trace.event("droppedFrame")
+            PipelineTelemetry.shared.recordDrop(.capture)
             return
         }
         isProcessing = true
@@ -334,9 +344,11 @@ extension FrontVisionPipeline: AVCaptureVideoDataOutputSampleBufferDelegate {
         }
 
         guard let pixelBuffer = CMSampleBufferGetImageBuffer(sampleBuffer) else { return }
+        // Video data output stamps frames on the host clock, the same clock as ARFrame.timestamp
+        let captureTime = CMSampleBufferGetPresentationTimeStamp(sampleBuffer).seconds
 
         let handler = VNImageRequestHandler(cvPixelBuffer: pixelBuffer, options: [:])
-        try? handler.perform([visionRequest])
+        Trace.interval("detection") { try? handler.perform([visionRequest]) }
 
         let observations = visionRequest.results ?? []
         let faces = observations.map { observation -> DetectedFace in
@@ -348,13 +360,11 @@ extension FrontVisionPipeline: AVCaptureVideoDataOutputSampleBufferDelegate {
                 roll: observation.roll?.floatValue,
                 worldPosition: nil,
                 transform: nil,
-                blendShapes: nil
+                blendShapes: nil,
+                captureTime: captureTime
             )
         }
 
-        DispatchQueue.main.async { [weak self] in
-            self?.onFacesDetected?(faces)
-            self?.onFrameCapture?(pixelBuffer, faces, .up)
-        }
+        onFrameCapture?(pixelBuffer, faces, .up)
     }
 }
@@ -10,7 +10,6 @@ import ARKit
 class PipelineCoordinator: ObservableObject, PipelineCoordinatorProtocol {
     @Published var previewLayer: AVCaptureVideoPreviewLayer?
     @Published var arSession: ARSession?
-    @Published var faces: [DetectedFace] = []
     @Published var isBackCamera: Bool = false
     @Published var isARKitActive: Bool = false
     @Published var pipelineInfo: String = "Initializing..."
@@ -22,9 +21,15 @@ class PipelineCoordinator: ObservableObject, PipelineCoordinatorProtocol {
     private var isPaused: Bool = false
     private var currentSettings: InferenceSettings = InferenceSettings()
 
-    // Frame callback for inference - includes orientation for Vision alignment
-    var onFrameCapture: ((CVPixelBuffer, [DetectedFace], CGImagePropertyOrientation) -> Void)?
-    var onDepthCapture: ((CVPixelBuffer) -> Void)?
+    // Frame callback for inference - includes orientation for Vision alignment.
+    // Handed straight to the active pipeline, which calls it on its processing queue, so per
+    // frame nothing hops to the main thread and no published property changes
+    var onFrameCapture: PipelineCallbacks.FrameHandler? {
+        didSet { activePipeline?.onFrameCapture = onFrameCapture }
+    }
+    var onDepthCapture: PipelineCallbacks.DepthHandler? {
+        didSet { activePipeline?.onDepthCapture = onDepthCapture }
+    }
     
     init() {
         // Initialize pipelines lazily or upfront? 
@@ -61,20 +66,9 @@ class PipelineCoordinator: ObservableObject, PipelineCoordinatorProtocol {
                 Log.debug("Starting pipeline: \(pipeline.id)")
                 
                 // Wire up callbacks
-                pipeline.onFrameCapture = { [weak self] buffer, faces, orientation in
-                    self?.onFrameCapture?(buffer, faces, orientation)
-                }
-                
-                pipeline.onDepthCapture = { [weak self] buffer in
-                    self?.onDepthCapture?(buffer)
-                }
-                
-                pipeline.onFacesDetected = { [weak self] faces in
-                    DispatchQueue.main.async {
-                        self?.faces = faces
-                    }
-                }
-                
+                pipeline.onFrameCapture = self.onFrameCapture
+                pipeline.onDepthCapture = self.onDepthCapture
+
                 pipeline.start()
                 
                 self.previewLayer = pipeline.previewLayer
@@ -95,14 +89,12 @@ class PipelineCoordinator: ObservableObject, PipelineCoordinatorProtocol {
         if let active = activePipeline {
             Log.debug("Stopping active pipeline: \(active.id)")
             active.onFrameCapture = nil
-            active.onFacesDetected = nil
             active.onDepthCapture = nil
             active.stop {
                 Log.debug("Stopped pipeline: \(active.id)")
                 // Start new pipeline after stop completes to avoid overlapping sessions.
-                DispatchQueue.global(qos: .userInitiated).asyncAfter(deadline: .now() + 0.3) {
-                    startNewPipeline()
-                }
+                // Pipelines and the model stay loaded, so no settle delay is needed.
+                startNewPipeline()
             }
         } else {
             startNewPipeline()
@@ -69,6 +69,35 @@ struct CameraPreviewView: UIViewRepresentable {
     }
 }
 
+// MARK: - Telemetry Overlay
+/// Rolling glass-to-glass latency, per-stage drops and queue depth from `PipelineTelemetry`,
+/// read twice a second rather than on every frame
+struct TelemetryOverlay: View {
+    var telemetry: PipelineTelemetry = .shared
+
+    var body: some View {
+        TimelineView(.periodic(from: .now, by: 0.5)) { _ in
+            let snapshot = telemetry.snapshot()
+            VStack(alignment: .leading, spacing: 2) {
+                Text("Glass-to-glass " + Self.format(snapshot.glassToGlass))
+                Text("Inference " + Self.format(snapshot.inference))
+                ForEach(snapshot.stages, id: \.stage) { stage in
+                    Text(stage.description)
+                }
+                Text(String(format: "Last %.0f s", snapshot.windowSeconds))
+                    .foregroundColor(.secondary)
+            }
+            .font(.system(.caption2, design: .monospaced))
+            .padding(8)
+            .background(.ultraThinMaterial, in: RoundedRectangle(cornerRadius: 8))
+        }
+    }
+
+    private static func format(_ latency: PipelineTelemetry.LatencySummary) -> String {
+        String(format: "p50 %.0f / p95 %.0f / p99 %.0f ms", latency.p50, latency.p95, latency.p99)
+    }
+}
+
 extension Collection {
     subscript(safe index: Index) -> Element? {
         indices.contains(index) ? self[index] : nil
@@ -228,6 +257,16 @@ struct SettingsSheet: View {
                         .font(.caption)
                         .foregroundColor(.secondary)
                 }
+
+                Section("Diagnostics") {
+                    Toggle("Show Telemetry", isOn: Binding(
+                        get: { settings.showTelemetry },
+                        set: { settings = settings.updating(showTelemetry: $0) }
+                    ))
+                    Text("Glass-to-glass latency, dropped frames and queue depth over the last 10 s")
+                        .font(.caption)
+                        .foregroundColor(.secondary)
+                }
             }
             .navigationTitle("Inference Settings")
             #if os(iOS)
@@ -0,0 +1,123 @@
+//
+//  FaceBatch.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include "FacePreprocessor.h"
+#include "ModelOutput.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <cstddef>
+
+// All face crops of one frame packed into a single contiguous N×H×W×C tensor, stored as
+// N crops stacked vertically in one continuous Mat (row r of face i is tensor row i*H + r).
+// The tensor is allocated once for maxFaces, or wraps caller memory such as the model
+// input's own buffer; add() samples each face straight out of the frame into its slot, so
+// packing a frame makes no temporary images and does not allocate.
+// Crops are sampled with sampleFaceInto (FacePreprocessor.h), the same math the iOS Metal
+// kernel uses, so both platforms feed the model the same pixels for the same face.
+// For a model that takes 1-channel input, construct with channels = 1.
+class FaceBatch {
+private:
+    size_t maxFaces;
+    size_t count = 0;
+    int height;
+    int width;
+    cv::Mat tensor;
+
+public:
+    FaceBatch(size_t maxFaces, int height, int width, int channels = 3)
+        : maxFaces(maxFaces), height(height), width(width),
+          tensor(static_cast<int>(maxFaces) * height, width, CV_8UC(channels)) {}
+
+    // Pack into caller-owned memory (e.g. the model input's buffer) instead of allocating.
+    // Capacity is however many whole H×W×C faces fit in `storage`, at most maxFaces.
+    FaceBatch(std::span<uint8_t> storage, size_t maxFaces, int height, int width, int channels = 3)
+        : maxFaces(std::min(maxFaces, storage.size() / (static_cast<size_t>(height) * width * channels))),
+          height(height), width(width),
+          tensor(static_cast<int>(this->maxFaces) * height, width, CV_8UC(channels), storage.data()) {}
+
+    // Sample `face` (pixels, clipped to the frame) out of the 8-bit gray or BGR `frame` into
+    // the next slot. Returns false (and packs nothing) when the face misses the frame or the
+    // batch is full.
+    bool add(const cv::Mat& frame, const cv::Rect& face) {
+        const cv::Rect clipped = face & cv::Rect(0, 0, frame.cols, frame.rows);
+        if (clipped.empty() || frame.depth() != CV_8U || count == maxFaces)
+            return false;
+        cv::Mat slot = this->face(count);
+        sampleFaceInto(frame, toFaceRect(clipped, frame.size()), kFaceOrientationUp, slot);
+        count++;
+        return true;
+    }
+
+    void clear() { count = 0; }
+
+    // Header over slot i; no copy.
+    cv::Mat face(size_t i) const {
+        return tensor.rowRange(static_cast<int>(i) * height, static_cast<int>(i + 1) * height);
+    }
+    // Header over the packed faces, (size() * H) rows of W pixels.
+    cv::Mat packed() const { return tensor.rowRange(0, static_cast<int>(count) * height); }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return maxFaces; }
+    bool empty() const { return count == 0; }
+};
+
+// A predictor whose bridge exposes a single-launch batch entry point: run the model once on
+// the packed tensor of `count` faces and write count × numClasses probabilities row-major.
+template<typename Predictor>
+concept BatchFacePredictor = requires(Predictor& predictor, const cv::Mat& packed, size_t count, std::span<float> out) {
+    { predictor.predictBatch(packed, count, out) } -> std::convertible_to<bool>;
+};
+
+// A bridge that hands back the model's raw logits in place (a view of the MLMultiArray
+// output, valid until its next call) instead of copying them into a vector, so the shared
+// ModelOutput.h stage does the softmax without allocating.
+template<typename Predictor>
+concept BatchLogitsFacePredictor = requires(Predictor& predictor, const cv::Mat& packed, size_t count) {
+    { predictor.predictBatchLogits(packed, count) } -> std::convertible_to<ModelOutputView>;
+};
+
+template<typename Predictor>
+concept LogitsFacePredictor = requires(Predictor& predictor, const cv::Mat& face) {
+    { predictor.predictLogits(face) } -> std::convertible_to<ModelOutputView>;
+};
+
+// Fill `out` with batch.size() × numClasses probabilities, one row per packed face.
+// Prefers one model launch per frame (batch entry points), then logits read in place, and
+// otherwise falls back to one predict() per face. Returns false if any row is missing.
+template<typename Predictor>
+bool predictBatch(Predictor& predictor, const FaceBatch& batch, std::span<float> out, size_t numClasses) {
+    const size_t total = batch.size() * numClasses;
+    if (out.size() < total)
+        return false;
+    if constexpr (BatchFacePredictor<Predictor>) {
+        return predictor.predictBatch(batch.packed(), batch.size(), out.first(total));
+    } else if constexpr (BatchLogitsFacePredictor<Predictor>) {
+        const ModelOutputView logits = predictor.predictBatchLogits(batch.packed(), batch.size());
+        return logits.rows == batch.size() && logits.classes == numClasses && softmaxOutput(logits, out.first(total));
+    } else if constexpr (LogitsFacePredictor<Predictor>) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const ModelOutputView logits = predictor.predictLogits(batch.face(i));
+            if (logits.rows != 1 || logits.classes != numClasses
+                || !softmaxOutput(logits, out.subspan(i * numClasses, numClasses)))
+                return false;
+        }
+        return true;
+    } else {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const std::vector<float> probabilities = predictor.predict(batch.face(i));
+            if (probabilities.size() != numClasses)
+                return false;
+            std::copy(probabilities.begin(), probabilities.end(), out.begin() + i * numClasses);
+        }
+        return true;
+    }
+}
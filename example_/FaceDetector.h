@@ -0,0 +1,252 @@
+//
+//  FaceDetector.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Size limits and cascade tuning for one detect() call, in the input image's pixels.
+// scaleFactor and minNeighbors only tune cascades; an empty maxSize means no upper limit.
+struct DetectionParams {
+    double scaleFactor = 1.1;
+    int minNeighbors = 5;
+    cv::Size minSize{ 30, 30 };
+    cv::Size maxSize;
+};
+
+// Face detector backend behind FaceTracker. Chosen at runtime (makeFaceDetector), so the
+// desktop engine, the server and the benchmark can swap the Haar cascade for a tiled LBP
+// cascade or a DNN without recompiling. An instance is used by one thread at a time;
+// backends that parallelize do so inside detect().
+class FaceDetector {
+public:
+    virtual ~FaceDetector() = default;
+
+    // Faces in one equalized grayscale image, in its pixel coordinates; replaces `faces`.
+    virtual void detect(const cv::Mat& gray, std::vector<cv::Rect>& faces, const DetectionParams& params) = 0;
+
+    // Faces in several images at once (e.g. one frame per stream). The default runs detect()
+    // per image; backends for which one call over many images is cheaper override it.
+    virtual void detectBatch(std::span<const cv::Mat> grays, std::span<std::vector<cv::Rect>> faces,
+        const DetectionParams& params) {
+        for (size_t i = 0; i < grays.size(); ++i)
+            detect(grays[i], faces[i], params);
+    }
+
+    // Whether detectBatch() beats the same number of detect() calls.
+    virtual bool batches() const { return false; }
+
+    virtual std::string name() const = 0;
+};
+
+// OpenCV cascade (Haar or LBP, whichever the XML holds) on the calling thread.
+class CascadeDetector : public FaceDetector {
+private:
+    cv::CascadeClassifier classifier;
+
+public:
+    bool load(const std::string& path) { return classifier.load(path); }
+
+    void detect(const cv::Mat& gray, std::vector<cv::Rect>& faces, const DetectionParams& params) override {
+        classifier.detectMultiScale(gray, faces, params.scaleFactor, params.minNeighbors, cv::CASCADE_SCALE_IMAGE,
+            params.minSize, params.maxSize);
+    }
+
+    std::string name() const override { return "cascade"; }
+};
+
+// A cascade tiled across cores: the image is cut into horizontal bands that are searched in
+// parallel for faces up to `overlap` tall, where each band extends `overlap` rows past its
+// core so every such face lies wholly inside the band its top edge falls in. One more task
+// searches the whole image for faces taller than `overlap`, which lets it start at a coarse
+// scale and stay cheap. Faces are kept by the band owning their top edge, so bands never
+// report the same face twice. The overlap means the small scales search about twice the image
+// in total, but the slowest task only covers 2 / tiles of it. Best with an LBP cascade, whose
+// integer features make each band's pass several times faster than Haar.
+// CascadeClassifier is not thread-safe, so every task owns a loaded copy.
+class TiledCascadeDetector : public FaceDetector {
+private:
+    std::vector<cv::CascadeClassifier> classifiers;  // One per band, plus one for large faces.
+    std::vector<std::vector<cv::Rect>> taskFaces;
+
+    static double overlapRatio(const cv::Rect& a, const cv::Rect& b) {
+        const double inter = (a & b).area();
+        return inter / (a.area() + b.area() - inter);
+    }
+
+public:
+    // tiles = 0: one band per hardware thread.
+    explicit TiledCascadeDetector(size_t tiles = 0)
+        : classifiers(std::max<size_t>(tiles ? tiles : std::thread::hardware_concurrency(), 1) + 1),
+          taskFaces(classifiers.size()) {}
+
+    bool load(const std::string& path) {
+        return std::all_of(classifiers.begin(), classifiers.end(),
+            [&](cv::CascadeClassifier& classifier) { return classifier.load(path); });
+    }
+
+    size_t tiles() const { return classifiers.size() - 1; }
+
+    void detect(const cv::Mat& gray, std::vector<cv::Rect>& faces, const DetectionParams& params) override {
+        const int bands = static_cast<int>(tiles());
+        const int core = (gray.rows + bands - 1) / bands;
+        const int maxFace = params.maxSize.height > 0 ? std::min(params.maxSize.height, gray.rows) : gray.rows;
+        const int overlap = std::min(std::max(core, params.minSize.height), maxFace);
+        if (bands == 1 || overlap >= gray.rows) {
+            classifiers[0].detectMultiScale(gray, faces, params.scaleFactor, params.minNeighbors,
+                cv::CASCADE_SCALE_IMAGE, params.minSize, params.maxSize);
+            return;
+        }
+
+        const cv::Size bandMax(params.maxSize.width > 0 ? std::min(params.maxSize.width, overlap) : overlap, overlap);
+        cv::parallel_for_(cv::Range(0, bands + 1), [&](const cv::Range& range) {
+            for (int t = range.start; t < range.end; ++t) {
+                std::vector<cv::Rect>& found = taskFaces[t];
+                found.clear();
+                if (t == bands) {
+                    // Faces too tall for a band.
+                    if (maxFace > overlap) {
+                        classifiers[t].detectMultiScale(gray, found, params.scaleFactor, params.minNeighbors,
+                            cv::CASCADE_SCALE_IMAGE, cv::Size(overlap, overlap), params.maxSize);
+                    }
+                    continue;
+                }
+                const int top = t * core;
+                if (top >= gray.rows)
+                    continue;
+                const cv::Rect band(0, top, gray.cols, std::min(gray.rows, top + core + overlap) - top);
+                classifiers[t].detectMultiScale(gray(band), found, params.scaleFactor, params.minNeighbors,
+                    cv::CASCADE_SCALE_IMAGE, params.minSize, bandMax);
+                found.erase(std::remove_if(found.begin(), found.end(), [&](const cv::Rect& face) { return face.y >= core; }),
+                    found.end());
+                for (cv::Rect& face : found)
+                    face.y += top;
+            }
+        });
+
+        faces.clear();
+        for (int t = 0; t < bands; ++t)
+            faces.insert(faces.end(), taskFaces[t].begin(), taskFaces[t].end());
+        // Both passes may find a face right at the overlap size; keep the band's box.
+        const size_t banded = faces.size();
+        for (const cv::Rect& face : taskFaces[bands]) {
+            const bool duplicate = std::any_of(faces.begin(), faces.begin() + banded,
+                [&](const cv::Rect& other) { return overlapRatio(face, other) >= 0.5; });
+            if (!duplicate)
+                faces.push_back(face);
+        }
+    }
+
+    std::string name() const override { return "tiled cascade x" + std::to_string(tiles()); }
+};
+
+// SSD-style DNN face detector through OpenCV DNN, e.g. the res10 300x300 Caffe model or an
+// ONNX export of it: output rows are [image, class, confidence, x0, y0, x1, y1] with
+// normalized corners. detectBatch() packs every image into one blob, so a single forward
+// pass serves frames of several streams.
+struct DnnDetectorSettings {
+    cv::Size inputSize{ 300, 300 };
+    cv::Scalar mean{ 104.0, 177.0, 123.0 };
+    double scale = 1.0;
+    bool swapRB = false;
+    float minConfidence = 0.5f;
+};
+
+class DnnFaceDetector : public FaceDetector {
+private:
+    cv::dnn::Net net;
+    DnnDetectorSettings settings;
+    std::vector<cv::Mat> inputs;  // Grayscale frames replicated to 3 channels.
+    cv::Mat blob;
+
+public:
+    explicit DnnFaceDetector(const DnnDetectorSettings& settings = {}) : settings(settings) {}
+
+    bool load(const std::string& model, const std::string& config = "") {
+        net = cv::dnn::readNet(model, config);
+        if (net.empty())
+            return false;
+        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        return true;
+    }
+
+    void detect(const cv::Mat& gray, std::vector<cv::Rect>& faces, const DetectionParams& params) override {
+        detectBatch(std::span<const cv::Mat>(&gray, 1), std::span<std::vector<cv::Rect>>(&faces, 1), params);
+    }
+
+    void detectBatch(std::span<const cv::Mat> grays, std::span<std::vector<cv::Rect>> faces,
+        const DetectionParams& params) override {
+        inputs.resize(grays.size());
+        for (size_t i = 0; i < grays.size(); ++i) {
+            faces[i].clear();
+            if (grays[i].channels() == 1)
+                cv::cvtColor(grays[i], inputs[i], cv::COLOR_GRAY2BGR);
+            else
+                inputs[i] = grays[i];
+        }
+        if (grays.empty())
+            return;
+        blob = cv::dnn::blobFromImages(inputs, settings.scale, settings.inputSize, settings.mean, settings.swapRB, false);
+        net.setInput(blob);
+        const cv::Mat detections = net.forward();
+
+        const float* row = detections.ptr<float>();
+        const size_t rows = detections.total() / 7;
+        for (size_t r = 0; r < rows; ++r, row += 7) {
+            const size_t image = static_cast<size_t>(row[0]);
+            if (image >= grays.size() || row[2] < settings.minConfidence)
+                continue;
+            const cv::Mat& gray = grays[image];
+            const int x0 = static_cast<int>(row[3] * gray.cols), y0 = static_cast<int>(row[4] * gray.rows);
+            const int x1 = static_cast<int>(row[5] * gray.cols), y1 = static_cast<int>(row[6] * gray.rows);
+            const cv::Rect face = cv::Rect(x0, y0, x1 - x0, y1 - y0) & cv::Rect(0, 0, gray.cols, gray.rows);
+            if (face.width < params.minSize.width || face.height < params.minSize.height)
+                continue;
+            if ((params.maxSize.width > 0 && face.width > params.maxSize.width)
+                || (params.maxSize.height > 0 && face.height > params.maxSize.height))
+                continue;
+            faces[image].push_back(face);
+        }
+    }
+
+    bool batches() const override { return true; }
+
+    std::string name() const override { return "dnn"; }
+};
+
+// Detector from a command-line spec; nullptr if it cannot be loaded.
+//   <cascade.xml>             CascadeDetector
+//   tiled[N]:<cascade.xml>    TiledCascadeDetector over N bands (default: one per core)
+//   dnn:<model>[:<config>]    DnnFaceDetector, e.g. dnn:res10.caffemodel:deploy.prototxt
+inline std::unique_ptr<FaceDetector> makeFaceDetector(const std::string& spec) {
+    const size_t colon = spec.find(':');
+    const std::string kind = colon == std::string::npos ? "" : spec.substr(0, colon);
+    const std::string rest = colon == std::string::npos ? spec : spec.substr(colon + 1);
+
+    if (kind == "dnn") {
+        const size_t split = rest.find(':');
+        auto detector = std::make_unique<DnnFaceDetector>();
+        if (detector->load(rest.substr(0, split), split == std::string::npos ? "" : rest.substr(split + 1)))
+            return detector;
+    } else if (kind.rfind("tiled", 0) == 0) {
+        auto detector = std::make_unique<TiledCascadeDetector>(static_cast<size_t>(std::atoi(kind.c_str() + 5)));
+        if (detector->load(rest))
+            return detector;
+    } else {
+        auto detector = std::make_unique<CascadeDetector>();
+        if (detector->load(spec))
+            return detector;
+    }
+    return nullptr;
+}
@@ -0,0 +1,99 @@
+//
+//  FacePreprocessor.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include "../Core/Metal/FacePreprocessing.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+
+// Face rectangle in pixels to the normalized, top-left-origin FaceRect the kernels take.
+inline FaceRect toFaceRect(const cv::Rect& face, const cv::Size& frame) {
+    return { static_cast<float>(face.x) / frame.width, static_cast<float>(face.y) / frame.height,
+             static_cast<float>(face.width) / frame.width, static_cast<float>(face.height) / frame.height };
+}
+
+// Bilinear luma of `face` at the center of every pixel of an outputWidth × outputHeight
+// crop, sampled like facePreprocessKernel (Core/Metal/FacePreprocess.metal) samples its
+// texture: calls visit(x, y, gray) with gray in [0, 1]. `frame` is 8-bit BGR or gray; the
+// face is in the upright image and `orientation` maps it onto the frame as stored.
+template<typename Visit>
+inline void sampleFace(const cv::Mat& frame, const FaceRect& face, uint32_t outputWidth, uint32_t outputHeight,
+    uint32_t orientation, Visit&& visit) {
+    const int channels = frame.channels();
+    const float maxX = static_cast<float>(frame.cols - 1);
+    const float maxY = static_cast<float>(frame.rows - 1);
+
+    // Luma of texel (x, y) in [0, 1], like sampling a bgra8Unorm texture.
+    const auto luma = [&](const uint8_t* row, int x) {
+        const uint8_t* p = row + static_cast<size_t>(x) * channels;
+        if (channels < 3)
+            return p[0] / 255.0f;
+        return faceLuma(p[2] / 255.0f, p[1] / 255.0f, p[0] / 255.0f);
+    };
+
+    for (uint32_t y = 0; y < outputHeight; ++y) {
+        const float v = faceSourceCoordinate(face.y, face.height, y, outputHeight);
+        for (uint32_t x = 0; x < outputWidth; ++x) {
+            const float u = faceSourceCoordinate(face.x, face.width, x, outputWidth);
+            // Texel-center convention of a linear, clamp-to-edge sampler.
+            const float sx = std::clamp(faceStoredX(u, v, orientation) * frame.cols - 0.5f, 0.0f, maxX);
+            const float sy = std::clamp(faceStoredY(u, v, orientation) * frame.rows - 0.5f, 0.0f, maxY);
+            const int y0 = static_cast<int>(sy);
+            const int x0 = static_cast<int>(sx);
+            const int x1 = std::min(x0 + 1, frame.cols - 1);
+            const uint8_t* top = frame.ptr<uint8_t>(y0);
+            const uint8_t* bottom = frame.ptr<uint8_t>(std::min(y0 + 1, frame.rows - 1));
+            const float a = sx - x0;
+            const float b = sy - y0;
+
+            const float topLeft = luma(top, x0), topRight = luma(top, x1);
+            const float bottomLeft = luma(bottom, x0), bottomRight = luma(bottom, x1);
+            const float upper = topLeft + a * (topRight - topLeft);
+            const float lower = bottomLeft + a * (bottomRight - bottomLeft);
+            visit(x, y, upper + b * (lower - upper));
+        }
+    }
+}
+
+// CPU twin of facePreprocessKernel: crop + grayscale + bilinear resize + normalize for every
+// face, straight from the 8-bit BGR (or gray) frame into NCHW float32 tensors in `output`.
+// Sampling, luma, normalization and layout all come from FacePreprocessing.h, so both paths
+// produce the same tensors up to float rounding.
+// Returns how many faces were written: min(faces, params.faceCount, output capacity).
+inline size_t preprocessFaces(const cv::Mat& frame, std::span<const FaceRect> faces,
+    const FacePreprocessParams& params, std::span<float> output) {
+    const size_t faceStride = static_cast<size_t>(params.channels) * params.outputHeight * params.outputWidth;
+    if (frame.empty() || frame.depth() != CV_8U || faceStride == 0)
+        return 0;
+    const size_t count = std::min({ faces.size(), static_cast<size_t>(params.faceCount), output.size() / faceStride });
+    for (size_t f = 0; f < count; ++f) {
+        sampleFace(frame, faces[f], params.outputWidth, params.outputHeight, params.orientation,
+            [&](uint32_t x, uint32_t y, float gray) {
+                const float value = faceNormalize(gray, params.scale, params.bias);
+                for (uint32_t c = 0; c < params.channels; ++c) {
+                    output[faceTensorIndex(static_cast<uint32_t>(f), c, y, x, params.channels,
+                        params.outputHeight, params.outputWidth)] = value;
+                }
+            });
+    }
+    return count;
+}
+
+// The same samples as 8-bit pixels (gray * 255, rounded) written into every channel of an
+// 8-bit slot, for the desktop FaceBatch whose models take 0-255 input.
+inline void sampleFaceInto(const cv::Mat& frame, const FaceRect& face, uint32_t orientation, cv::Mat& slot) {
+    const int channels = slot.channels();
+    sampleFace(frame, face, static_cast<uint32_t>(slot.cols), static_cast<uint32_t>(slot.rows), orientation,
+        [&](uint32_t x, uint32_t y, float gray) {
+            uint8_t* out = slot.ptr<uint8_t>(static_cast<int>(y)) + static_cast<size_t>(x) * channels;
+            const uint8_t value = static_cast<uint8_t>(gray * 255.0f + 0.5f);
+            for (int c = 0; c < channels; ++c)
+                out[c] = value;
+        });
+}
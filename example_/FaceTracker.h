@@ -0,0 +1,227 @@
+//
+//  FaceTracker.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include "FaceDetector.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <vector>
+#include <cstddef>
+
+// Detector parameters plus the detect-every-N schedule.
+struct DetectionSettings {
+    double scaleFactor = 1.1;
+    int minNeighbors = 5;
+    cv::Size minSize{ 30, 30 };  // In full-resolution pixels.
+    // Smallest face the detector can find in its input (a cascade's training window).
+    cv::Size detectorWindow{ 24, 24 };
+
+    // Full detections run on a copy scaled by this factor (1 = full resolution; opt in to less).
+    // Boxes are mapped back to full resolution, so crops for inference always use the original
+    // pixels. The scale never drops below detectorWindow / minSize, so downscaling cannot
+    // raise the smallest detectable face above minSize.
+    double detectionScale = 1.0;
+    // Every recallCheckInterval full detections, also run the full-resolution cascade and
+    // count how many of its faces the scaled pass found (0 = never; costs one extra pass).
+    size_t recallCheckInterval = 0;
+
+    // Full-frame detection runs every detectInterval frames (1 = every frame).
+    size_t detectInterval = 5;
+    // Search window around each last known face, as a fraction of the face size per side.
+    double roiMargin = 0.5;
+    // Normalized cross-correlation below which template tracking counts as lost.
+    double minTemplateScore = 0.6;
+};
+
+// The detection scale FaceTracker actually uses: detectionScale clamped to
+// [detectorWindow / minSize, 1], so a scale below that floor is raised to it.
+inline double effectiveDetectionScale(const DetectionSettings& settings) {
+    const double floor = std::max(static_cast<double>(settings.detectorWindow.width) / std::max(settings.minSize.width, 1),
+        static_cast<double>(settings.detectorWindow.height) / std::max(settings.minSize.height, 1));
+    return std::clamp(settings.detectionScale, std::min(std::max(floor, 0.05), 1.0), 1.0);
+}
+
+// Counters for tuning DetectionSettings; times are wall-clock milliseconds.
+struct DetectionStats {
+    double detectionScale = 1.0;
+    double scaleFactor = 1.1;
+    size_t frames = 0;
+    size_t fullDetections = 0;
+    double totalMs = 0;
+    double fullDetectionMs = 0;
+    size_t recallChecks = 0;
+    size_t referenceFaces = 0;  // Faces found by the full-resolution reference pass.
+    size_t recalledFaces = 0;   // Of those, faces the scaled pass also found (IoU >= 0.5).
+
+    double meanFrameMs() const { return frames ? totalMs / frames : 0; }
+    double meanFullDetectionMs() const { return fullDetections ? fullDetectionMs / fullDetections : 0; }
+    double recall() const { return referenceFaces ? static_cast<double>(recalledFaces) / referenceFaces : 1.0; }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const DetectionStats& stats) {
+    os << "detection scale " << stats.detectionScale << ", scaleFactor " << stats.scaleFactor
+       << ": " << stats.frames << " frames, " << stats.meanFrameMs() << " ms/frame, "
+       << stats.fullDetections << " full detections at " << stats.meanFullDetectionMs() << " ms";
+    if (stats.recallChecks)
+        os << ", recall " << stats.recall() * 100 << "% (" << stats.recalledFaces << "/" << stats.referenceFaces
+           << " over " << stats.recallChecks << " checks)";
+    return os;
+}
+
+// Keeps face boxes current while running the full-frame cascade only every detectInterval
+// frames. On the frames in between, each face is re-detected inside a small window around
+// its last box; when that misses, it is followed by template matching against the patch
+// from the previous frame. If a face is lost by both, the frame falls back to a full
+// detection immediately, so tracking failures never last past one frame.
+// Full detections can run on a downscaled copy (shallower scale pyramid); the resulting
+// boxes are always in full-resolution coordinates.
+class FaceTracker {
+private:
+    DetectionSettings settings;
+    std::vector<cv::Rect> faces;
+    std::vector<cv::Rect> candidates;   // Detector scratch.
+    std::vector<cv::Mat> templates;     // Grayscale patch per face from the last frame.
+    cv::Mat matchScores;                // matchTemplate scratch.
+    cv::Mat scaled;                     // Downscaled detection input.
+    DetectionStats detectionStats;
+    size_t framesSinceDetect = 0;
+    bool fullDetection = false;
+
+    cv::Rect searchWindow(const cv::Rect& face, const cv::Mat& gray) const {
+        const int dx = static_cast<int>(face.width * settings.roiMargin);
+        const int dy = static_cast<int>(face.height * settings.roiMargin);
+        return cv::Rect(face.x - dx, face.y - dy, face.width + 2 * dx, face.height + 2 * dy)
+            & cv::Rect(0, 0, gray.cols, gray.rows);
+    }
+
+    void detectFull(const cv::Mat& gray, FaceDetector& detector) {
+        const auto start = std::chrono::steady_clock::now();
+        const cv::Rect frame(0, 0, gray.cols, gray.rows);
+        const double scale = effectiveDetectionScale(settings);
+
+        cv::Mat input = gray;
+        if (scale < 1.0) {
+            cv::resize(input, scaled, cv::Size(), scale, scale, cv::INTER_AREA);
+            input = scaled;
+        }
+        const cv::Size minSize(std::max(1, static_cast<int>(settings.minSize.width * scale)),
+                               std::max(1, static_cast<int>(settings.minSize.height * scale)));
+        detector.detect(input, faces, { settings.scaleFactor, settings.minNeighbors, minSize, cv::Size() });
+        for (auto& face : faces) {
+            face = cv::Rect(static_cast<int>(face.x / scale), static_cast<int>(face.y / scale),
+                            static_cast<int>(face.width / scale), static_cast<int>(face.height / scale)) & frame;
+        }
+
+        framesSinceDetect = 0;
+        fullDetection = true;
+        detectionStats.fullDetections++;
+        detectionStats.fullDetectionMs +=
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (scale < 1.0 && settings.recallCheckInterval > 0
+            && detectionStats.fullDetections % settings.recallCheckInterval == 0)
+            checkRecall(gray, detector);
+    }
+
+    // Reference pass at full resolution over the same frame.
+    void checkRecall(const cv::Mat& gray, FaceDetector& detector) {
+        detector.detect(gray, candidates, { settings.scaleFactor, settings.minNeighbors, settings.minSize, cv::Size() });
+        detectionStats.recallChecks++;
+        for (const auto& reference : candidates) {
+            const bool found = std::any_of(faces.begin(), faces.end(), [&](const cv::Rect& face) {
+                const double inter = (face & reference).area();
+                return inter / (face.area() + reference.area() - inter) >= 0.5;
+            });
+            detectionStats.referenceFaces++;
+            detectionStats.recalledFaces += found ? 1 : 0;
+        }
+    }
+
+    // Detector restricted to the window around `face` and to nearby scales.
+    bool redetect(const cv::Mat& gray, FaceDetector& detector, cv::Rect& face) {
+        const cv::Rect window = searchWindow(face, gray);
+        if (window.width < settings.minSize.width || window.height < settings.minSize.height)
+            return false;
+        const cv::Size minSize(std::max(settings.minSize.width, face.width * 2 / 3),
+                               std::max(settings.minSize.height, face.height * 2 / 3));
+        const cv::Size maxSize(face.width * 3 / 2, face.height * 3 / 2);
+        detector.detect(gray(window), candidates, { settings.scaleFactor, settings.minNeighbors, minSize, maxSize });
+        if (candidates.empty())
+            return false;
+
+        // Several hits: keep the one whose center moved least.
+        const cv::Point center(face.x + face.width / 2 - window.x, face.y + face.height / 2 - window.y);
+        const auto distance = [&](const cv::Rect& r) {
+            const int cx = r.x + r.width / 2 - center.x, cy = r.y + r.height / 2 - center.y;
+            return cx * cx + cy * cy;
+        };
+        face = *std::min_element(candidates.begin(), candidates.end(),
+            [&](const cv::Rect& a, const cv::Rect& b) { return distance(a) < distance(b); }) + window.tl();
+        return true;
+    }
+
+    // Best match of the previous frame's patch inside the window, if confident enough.
+    bool trackTemplate(const cv::Mat& gray, size_t i, cv::Rect& face) {
+        const cv::Mat& patch = templates[i];
+        const cv::Rect window = searchWindow(face, gray);
+        if (patch.empty() || window.width < patch.cols || window.height < patch.rows)
+            return false;
+        cv::matchTemplate(gray(window), patch, matchScores, cv::TM_CCOEFF_NORMED);
+        double best = 0;
+        cv::Point bestAt;
+        cv::minMaxLoc(matchScores, nullptr, &best, nullptr, &bestAt);
+        if (best < settings.minTemplateScore)
+            return false;
+        face = cv::Rect(window.x + bestAt.x, window.y + bestAt.y, patch.cols, patch.rows);
+        return true;
+    }
+
+public:
+    explicit FaceTracker(const DetectionSettings& settings = {}) : settings(settings) {
+        detectionStats.detectionScale = effectiveDetectionScale(settings);
+        detectionStats.scaleFactor = settings.scaleFactor;
+    }
+
+    // Face boxes for this equalized grayscale frame. The reference stays valid until the next call.
+    const std::vector<cv::Rect>& update(const cv::Mat& gray, FaceDetector& detector) {
+        const auto start = std::chrono::steady_clock::now();
+        fullDetection = false;
+        if (faces.empty() || ++framesSinceDetect >= std::max<size_t>(settings.detectInterval, 1)) {
+            detectFull(gray, detector);
+        } else {
+            for (size_t i = 0; i < faces.size(); ++i) {
+                if (!redetect(gray, detector, faces[i]) && !trackTemplate(gray, i, faces[i])) {
+                    // Confidence check failed: re-acquire everything from a full detection.
+                    detectFull(gray, detector);
+                    break;
+                }
+            }
+        }
+
+        templates.resize(faces.size());
+        for (size_t i = 0; i < faces.size(); ++i)
+            gray(faces[i]).copyTo(templates[i]);
+
+        detectionStats.frames++;
+        detectionStats.totalMs +=
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return faces;
+    }
+
+    // Whether the last update() ran the full-frame cascade.
+    bool lastWasFullDetection() const { return fullDetection; }
+    const DetectionStats& stats() const { return detectionStats; }
+
+    const DetectionSettings& currentSettings() const { return settings; }
+
+    void reset() {
+        faces.clear();
+        templates.clear();
+        framesSinceDetect = 0;
+    }
+};
@@ -0,0 +1,84 @@
+//
+//  Float16.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// IEEE 754 binary16 conversions, since C++20 has no portable half type.
+// Used for float16 model outputs (ModelOutput.h) and float16 session recordings.
+
+namespace float16_detail {
+    // Table-driven half -> float (van der Zijp): the bits of the float are
+    // mantissa[offset[h >> 10] + (h & 0x3ff)] + exponent[h >> 10], with no branches.
+    struct HalfTables {
+        std::array<uint32_t, 2048> mantissa{};
+        std::array<uint32_t, 64> exponent{};
+        std::array<uint16_t, 64> offset{};
+
+        constexpr HalfTables() {
+            for (uint32_t i = 1; i < 1024; ++i) {  // Subnormal halves become normal floats.
+                uint32_t m = i << 13;
+                uint32_t e = 0;
+                while ((m & 0x00800000) == 0) {
+                    e -= 0x00800000;
+                    m <<= 1;
+                }
+                mantissa[i] = (m & ~0x00800000u) | (e + 0x38800000);
+            }
+            for (uint32_t i = 1024; i < 2048; ++i)
+                mantissa[i] = 0x38000000 + ((i - 1024) << 13);
+            for (uint32_t i = 1; i < 31; ++i) {
+                exponent[i] = i << 23;
+                exponent[i + 32] = 0x80000000 | (i << 23);
+            }
+            exponent[31] = 0x47800000;  // Inf / NaN.
+            exponent[32] = 0x80000000;
+            exponent[63] = 0xc7800000;
+            for (size_t i = 0; i < 64; ++i)
+                offset[i] = (i == 0 || i == 32) ? 0 : 1024;
+        }
+    };
+
+    inline constexpr HalfTables halfTables{};
+}
+
+inline float halfToFloat(uint16_t half) {
+    const float16_detail::HalfTables& t = float16_detail::halfTables;
+    const uint32_t high = half >> 10;
+    return std::bit_cast<float>(t.mantissa[t.offset[high] + (half & 0x3ff)] + t.exponent[high]);
+}
+
+// Float -> half, rounding to nearest even.
+inline uint16_t floatToHalf(float value) {
+    const uint32_t bits = std::bit_cast<uint32_t>(value);
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+    if (((bits >> 23) & 0xff) == 0xff)  // Inf / NaN.
+        return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    if (exponent >= 31)
+        return static_cast<uint16_t>(sign | 0x7c00);
+    if (exponent <= 0) {  // Subnormal or zero.
+        if (exponent < -10)
+            return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000;
+        const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        const uint32_t rest = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1)))
+            half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    const uint32_t rest = mantissa & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        half++;  // May carry into the exponent, which rounds up to the next power of two / Inf.
+    return static_cast<uint16_t>(sign | half);
+}
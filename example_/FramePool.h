@@ -0,0 +1,173 @@
+//
+//  FramePool.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <vector>
+
+struct FramePoolStats {
+    uint64_t hits = 0;      // Buffers served from the arena.
+    uint64_t misses = 0;    // Arena full or frame too large: fell back to the heap.
+    size_t inUse = 0;
+    size_t peakInUse = 0;
+    size_t slots = 0;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const FramePoolStats& s) {
+    return os << s.hits << " hits, " << s.misses << " misses, peak " << s.peakInUse << "/" << s.slots << " slots in use";
+}
+
+// Fixed arena of 64-byte-aligned frame buffers for the capture / detection / render Mats.
+// Installed as a Mat's allocator, so create() (and anything that calls it: VideoCapture::read,
+// cvtColor, copyTo) takes a slot and the slot is released when the last Mat header sharing
+// the buffer goes away, wherever that is in the pipeline. The arena and the UMatData headers
+// are allocated and prefaulted once, so steady-state frames allocate nothing; a request that
+// finds no free slot, or is larger than a slot, falls back to the heap and counts as a miss.
+//
+//   FramePool pool(24, width * height * 3);
+//   frame.image.allocator = &pool;   // acquire: the next create() takes a slot
+//   frame.image.release();           // release: explicit, or when the last header drops
+//
+// Every slot has the same size, so frames of another size (gray next to BGR) should get a
+// pool of their own rather than take a slot sized for the largest frame.
+//
+// Slots are claimed through one atomic bitmask (at most 64 slots), so any thread may
+// allocate or release. The pool must outlive every Mat it served.
+class FramePool : public cv::MatAllocator {
+private:
+    static constexpr size_t kAlignment = 64;
+
+    size_t slotCount;
+    size_t slotBytes;
+    uint8_t* arena = nullptr;
+    std::vector<cv::UMatData*> headers;
+    mutable std::atomic<uint64_t> used{ 0 };  // Bit i set: slot i is in use.
+    mutable std::atomic<uint64_t> hitCount{ 0 };
+    mutable std::atomic<uint64_t> missCount{ 0 };
+    mutable std::atomic<size_t> peak{ 0 };
+
+    // Claim the lowest free slot, or -1.
+    int claimSlot() const {
+        uint64_t mask = used.load(std::memory_order_relaxed);
+        const uint64_t all = slotCount == 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << slotCount) - 1;
+        while ((mask & all) != all) {
+            const int slot = std::countr_one(mask);
+            if (used.compare_exchange_weak(mask, mask | (uint64_t{ 1 } << slot), std::memory_order_acquire,
+                    std::memory_order_relaxed)) {
+                const size_t inUse = static_cast<size_t>(std::popcount(mask)) + 1;
+                size_t seen = peak.load(std::memory_order_relaxed);
+                while (inUse > seen && !peak.compare_exchange_weak(seen, inUse, std::memory_order_relaxed)) {}
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+    bool ownsData(const uint8_t* data) const {
+        return data >= arena && data < arena + slotCount * slotBytes;
+    }
+
+public:
+    // slotBytes is rounded up to the alignment; slots is clamped to [1, 64].
+    FramePool(size_t slots, size_t slotBytes)
+        : slotCount(std::clamp<size_t>(slots, 1, 64)), slotBytes((std::max<size_t>(slotBytes, 1) + kAlignment - 1) & ~(kAlignment - 1)) {
+        arena = static_cast<uint8_t*>(::operator new(slotCount * this->slotBytes, std::align_val_t{ kAlignment }));
+        std::memset(arena, 0, slotCount * this->slotBytes);  // Prefault, so first frames do not page in.
+        headers.reserve(slotCount);
+        for (size_t i = 0; i < slotCount; ++i)
+            headers.push_back(new cv::UMatData(this));
+    }
+
+    ~FramePool() override {
+        for (cv::UMatData* u : headers)
+            delete u;
+        ::operator delete(arena, std::align_val_t{ kAlignment });
+    }
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data0, size_t* step, cv::AccessFlag,
+        cv::UMatUsageFlags) const override {
+        // Same step layout as OpenCV's default allocator.
+        size_t total = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; i--) {
+            if (step) {
+                if (data0 && step[i] != CV_AUTOSTEP) {
+                    CV_Assert(total <= step[i]);
+                    total = step[i];
+                } else {
+                    step[i] = total;
+                }
+            }
+            total *= sizes[i];
+        }
+
+        cv::UMatData* u = nullptr;
+        uint8_t* data = static_cast<uint8_t*>(data0);
+        if (data0 == nullptr && total <= slotBytes) {
+            const int slot = claimSlot();
+            if (slot >= 0) {
+                u = headers[slot];
+                u->~UMatData();
+                new (u) cv::UMatData(this);
+                data = arena + slot * slotBytes;
+                hitCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (u == nullptr) {
+            u = new cv::UMatData(this);
+            if (data0 == nullptr) {
+                data = static_cast<uint8_t*>(cv::fastMalloc(total));
+                missCount.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                u->flags |= cv::UMatData::USER_ALLOCATED;
+            }
+        }
+        u->data = u->origdata = data;
+        u->size = total;
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag, cv::UMatUsageFlags) const override { return u != nullptr; }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (u == nullptr)
+            return;
+        CV_Assert(u->urefcount == 0 && u->refcount == 0);
+        if (ownsData(u->origdata)) {
+            // The header stays with its slot for reuse.
+            const size_t slot = static_cast<size_t>(u->origdata - arena) / slotBytes;
+            u->data = u->origdata = nullptr;
+            used.fetch_and(~(uint64_t{ 1 } << slot), std::memory_order_release);
+            return;
+        }
+        if (!(u->flags & cv::UMatData::USER_ALLOCATED))
+            cv::fastFree(u->origdata);
+        delete u;
+    }
+
+    size_t slots() const { return slotCount; }
+    size_t bytesPerSlot() const { return slotBytes; }
+
+    FramePoolStats stats() const {
+        FramePoolStats s;
+        s.hits = hitCount.load(std::memory_order_relaxed);
+        s.misses = missCount.load(std::memory_order_relaxed);
+        s.inUse = static_cast<size_t>(std::popcount(used.load(std::memory_order_relaxed)));
+        s.peakInUse = peak.load(std::memory_order_relaxed);
+        s.slots = slotCount;
+        return s;
+    }
+};
@@ -0,0 +1,139 @@
+//
+//  InferenceRateController.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <vector>
+
+// Device thermal pressure, same levels as ProcessInfo.ThermalState on iOS.
+enum class ThermalLevel { nominal, fair, serious, critical };
+
+struct RateControlSettings {
+    size_t maxInterval = 8;            // Most frames between two inferences.
+    float stableChange = 0.02f;        // Largest per-class output change that counts as stable.
+    float changeThreshold = 0.08f;     // Per-class output change that restores the full rate.
+    size_t stableObservationsToSlow = 10;  // Consecutive stable inferences before halving the rate.
+    size_t backlogLimit = 0;           // Frames queued ahead of inference before skipping.
+};
+
+struct RateControlStats {
+    uint64_t frames = 0;
+    uint64_t inferences = 0;
+    uint64_t skippedRate = 0;          // Skipped to hold the interval (stable output or thermal).
+    uint64_t skippedBacklog = 0;       // Skipped because the stage was behind.
+    double seconds = 0;
+
+    uint64_t skipped() const { return skippedRate + skippedBacklog; }
+    double inferenceRate() const { return seconds > 0 ? inferences / seconds : 0; }
+    double frameRate() const { return seconds > 0 ? frames / seconds : 0; }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const RateControlStats& s) {
+    return os << s.inferences << "/" << s.frames << " frames inferred (" << s.inferenceRate() << " Hz of "
+              << s.frameRate() << " Hz), skipped " << s.skippedRate << " by rate, " << s.skippedBacklog << " backlogged";
+}
+
+// Decides per frame whether to run inference.
+// The interval between inferences is the largest of three demands:
+//  - stability: doubles (up to maxInterval) after stableObservationsToSlow inferences whose
+//    smoothed output moved less than stableChange, and drops back to 1 as soon as one moves
+//    by changeThreshold or more;
+//  - thermal: 1 / 2 / 4 / maxInterval for nominal / fair / serious / critical;
+//  - backlog: any frame that arrives with more than backlogLimit frames queued is skipped.
+class InferenceRateController {
+private:
+    RateControlSettings settings;
+    ThermalLevel thermal = ThermalLevel::nominal;
+    size_t stabilityInterval = 1;
+    size_t stableRun = 0;
+    size_t framesSinceInference = 0;
+    bool hasOutput = false;
+    std::vector<float> lastOutput;
+    RateControlStats counters;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    size_t thermalInterval() const {
+        switch (thermal) {
+        case ThermalLevel::nominal: return 1;
+        case ThermalLevel::fair: return 2;
+        case ThermalLevel::serious: return 4;
+        case ThermalLevel::critical: return settings.maxInterval;
+        }
+        return 1;
+    }
+
+public:
+    explicit InferenceRateController(const RateControlSettings& settings = {})
+        : settings(settings) {}
+
+    // Call once per frame; true when this frame should go through the model.
+    // `backlog` is how many frames are waiting behind this one (or were discarded to reach it).
+    bool shouldInfer(size_t backlog = 0) {
+        counters.frames++;
+        framesSinceInference++;
+        if (backlog > settings.backlogLimit) {
+            counters.skippedBacklog++;
+            return false;
+        }
+        if (framesSinceInference < (hasOutput ? interval() : thermalInterval())) {
+            counters.skippedRate++;
+            return false;
+        }
+        framesSinceInference = 0;
+        counters.inferences++;
+        return true;
+    }
+
+    // Feed the smoothed output of the face the rate follows, after each inference.
+    void observe(std::span<const float> output) {
+        float change = 0;
+        if (hasOutput && lastOutput.size() == output.size()) {
+            for (size_t c = 0; c < output.size(); ++c)
+                change = std::max(change, std::abs(output[c] - lastOutput[c]));
+        } else {
+            change = settings.changeThreshold;
+        }
+        lastOutput.assign(output.begin(), output.end());
+        hasOutput = true;
+
+        if (change >= settings.changeThreshold) {
+            stabilityInterval = 1;
+            stableRun = 0;
+        } else if (change >= settings.stableChange) {
+            stableRun = 0;
+        } else if (++stableRun >= settings.stableObservationsToSlow) {
+            stabilityInterval = std::min(stabilityInterval * 2, std::max<size_t>(settings.maxInterval, 1));
+            stableRun = 0;
+        }
+    }
+
+    // Forget the followed output (e.g. another face is followed); back to the thermal limit.
+    void resetOutput() {
+        hasOutput = false;
+        stabilityInterval = 1;
+        stableRun = 0;
+    }
+
+    void setThermalLevel(ThermalLevel level) { thermal = level; }
+    ThermalLevel thermalLevel() const { return thermal; }
+
+    // Frames between inferences right now, ignoring backlog.
+    size_t interval() const {
+        return std::clamp(std::max(stabilityInterval, thermalInterval()), size_t{ 1 }, std::max<size_t>(settings.maxInterval, 1));
+    }
+
+    RateControlStats stats() const {
+        RateControlStats s = counters;
+        s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return s;
+    }
+};
@@ -0,0 +1,61 @@
+//
+//  LatencyStats.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Per-stage latency samples in milliseconds with nearest-rank percentiles.
+// Reserve up front with the expected sample count so recording never allocates mid-run.
+class LatencyRecorder {
+private:
+    std::string stageName;
+    std::vector<double> samples;
+    mutable std::vector<double> sorted;
+    mutable bool sortedValid = false;
+
+public:
+    explicit LatencyRecorder(std::string name, size_t expectedSamples = 0) : stageName(std::move(name)) {
+        samples.reserve(expectedSamples);
+    }
+
+    void record(double milliseconds) {
+        samples.push_back(milliseconds);
+        sortedValid = false;
+    }
+
+    void record(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+        record(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    // Nearest-rank percentile, p in [0, 100]; 0 when empty.
+    double percentile(double p) const {
+        if (samples.empty())
+            return 0;
+        if (!sortedValid) {
+            sorted = samples;
+            std::sort(sorted.begin(), sorted.end());
+            sortedValid = true;
+        }
+        const double rank = std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * sorted.size());
+        return sorted[std::max<size_t>(static_cast<size_t>(rank), 1) - 1];
+    }
+
+    double mean() const {
+        double total = 0;
+        for (double s : samples)
+            total += s;
+        return samples.empty() ? 0 : total / samples.size();
+    }
+
+    const std::string& name() const { return stageName; }
+    size_t count() const { return samples.size(); }
+    void reset() { samples.clear(); sortedValid = false; }
+};
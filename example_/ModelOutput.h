@@ -0,0 +1,91 @@
+//
+//  ModelOutput.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include "Float16.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+
+// Model output stage: logits straight from the model's output buffer (an MLMultiArray's
+// dataPointer, float16 or float32) to probabilities in caller-provided storage, with no
+// allocation and no per-element bridging.
+// Mirrored by `ModelOutput` in Core/ModelOutput.swift for the Swift predictor.
+
+enum class ModelOutputType { float16, float32 };
+
+// Non-owning view of a [rows x classes] logit tensor in the model's own buffer.
+// Strides are in elements, like MLMultiArray.strides.
+struct ModelOutputView {
+    const void* data = nullptr;
+    ModelOutputType type = ModelOutputType::float32;
+    size_t rows = 1;
+    size_t classes = 0;
+    size_t rowStride = 0;    // 0: rows are packed (rowStride == classes * classStride).
+    size_t classStride = 1;
+
+    size_t stride() const { return rowStride ? rowStride : classes * classStride; }
+};
+
+// Copy one row of logits to float, converting float16 through the Float16.h tables.
+inline void decodeLogits(const ModelOutputView& view, size_t row, std::span<float> out) {
+    const size_t base = row * view.stride();
+    if (view.type == ModelOutputType::float32) {
+        const float* in = static_cast<const float*>(view.data) + base;
+        if (view.classStride == 1) {
+            std::memcpy(out.data(), in, view.classes * sizeof(float));
+        } else {
+            for (size_t c = 0; c < view.classes; ++c)
+                out[c] = in[c * view.classStride];
+        }
+    } else {
+        const uint16_t* in = static_cast<const uint16_t*>(view.data) + base;
+        for (size_t c = 0; c < view.classes; ++c)
+            out[c] = halfToFloat(in[c * view.classStride]);
+    }
+}
+
+// Numerically stable softmax in place: subtracts the max logit so exp() never overflows.
+// Only the final scale loop vectorizes; exp() stays one libm call per element, which is
+// nothing next to the model at the 7 classes the FER models have.
+// Returns false (and leaves a uniform distribution) when the logits are not finite.
+inline bool softmaxInPlace(std::span<float> values) {
+    if (values.empty())
+        return false;
+    const float maxLogit = *std::max_element(values.begin(), values.end());
+    float sum = 0;
+    if (std::isfinite(maxLogit)) {
+        for (float& v : values) {
+            v = std::exp(v - maxLogit);
+            sum += v;
+        }
+    }
+    if (!(sum > 0) || !std::isfinite(sum)) {
+        std::fill(values.begin(), values.end(), 1.0f / values.size());
+        return false;
+    }
+    const float scale = 1.0f / sum;
+    for (float& v : values)
+        v *= scale;
+    return true;
+}
+
+// Softmax every row of `view` into `out` (rows x classes, row-major).
+inline bool softmaxOutput(const ModelOutputView& view, std::span<float> out) {
+    if (view.data == nullptr || view.classes == 0 || out.size() < view.rows * view.classes)
+        return false;
+    bool finite = true;
+    for (size_t r = 0; r < view.rows; ++r) {
+        const std::span<float> row = out.subspan(r * view.classes, view.classes);
+        decodeLogits(view, r, row);
+        finite &= softmaxInPlace(row);
+    }
+    return finite;
+}
@@ -0,0 +1,296 @@
+//
+//  PipelineTelemetry.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using TelemetryClock = std::chrono::steady_clock;
+
+constexpr size_t kTelemetrySlices = 10;  // Time slices per rolling window.
+
+// Time slices of a rolling window: the window is cut into `slices` consecutive slices stored
+// in a ring of rows, and a row is recycled when the clock moves past the slice it held. So
+// a series forgets samples older than the window in O(1) amortized and never allocates.
+class RollingWindow {
+private:
+    TelemetryClock::duration sliceLength;
+    size_t slices;
+    int64_t current = std::numeric_limits<int64_t>::min();  // Absolute number of the newest slice.
+
+public:
+    RollingWindow(TelemetryClock::duration window, size_t slices)
+        : sliceLength(std::max(window / static_cast<int64_t>(std::max<size_t>(slices, 1)), TelemetryClock::duration(1))),
+          slices(std::max<size_t>(slices, 1)) {}
+
+    // Row of now's slice. Calls evict(row) for every row whose slice falls out of the window;
+    // time going backwards keeps the newest slice.
+    template<typename Evict>
+    size_t advance(TelemetryClock::time_point now, Evict&& evict) {
+        const int64_t slice = now.time_since_epoch() / sliceLength;
+        if (slice > current) {
+            const int64_t first = current == std::numeric_limits<int64_t>::min()
+                ? slice - static_cast<int64_t>(slices) + 1
+                : std::max(current + 1, slice - static_cast<int64_t>(slices) + 1);
+            for (int64_t s = first; s <= slice; ++s)
+                evict(static_cast<size_t>(((s % static_cast<int64_t>(slices)) + slices) % slices));
+            current = slice;
+        }
+        return static_cast<size_t>(((current % static_cast<int64_t>(slices)) + slices) % slices);
+    }
+
+    size_t rows() const { return slices; }
+    double seconds() const { return std::chrono::duration<double>(sliceLength).count() * slices; }
+};
+
+// Histogram of the samples recorded over the last `window` (e.g. 10 s of frame latencies).
+// Buckets are fixed up front, so record() is O(1) and a percentile is one pass over the
+// buckets, however many samples the window holds. Logarithmic buckets suit latencies:
+// `bucketsPerOctave` per doubling between `low` and `high`, plus one below and one above, so
+// a percentile is within one bucket's ratio (2^(1/bucketsPerOctave)) of the exact value.
+// Linear buckets hold the integers 0..maxValue exactly, for queue depths.
+// Not thread-safe: record and read from one thread.
+class RollingHistogram {
+private:
+    RollingWindow window;
+    size_t buckets;
+    double low;
+    double logRatio;  // 0 for linear buckets.
+    std::vector<uint32_t> counts;  // Row-major: counts[row * buckets + bucket].
+    std::vector<uint64_t> totals;  // Per bucket, over every live row.
+    std::vector<uint32_t> rowCounts;
+    std::vector<double> rowSums;
+    std::vector<double> rowMax;
+    uint64_t total = 0;
+    double sum = 0;
+
+    RollingHistogram(TelemetryClock::duration windowLength, size_t bucketCount, double low, double logRatio)
+        : window(windowLength, kTelemetrySlices), buckets(bucketCount), low(low), logRatio(logRatio),
+          counts(window.rows() * bucketCount, 0), totals(bucketCount, 0), rowCounts(window.rows(), 0),
+          rowSums(window.rows(), 0.0), rowMax(window.rows(), 0.0) {}
+
+    size_t bucketOf(double value) const {
+        if (logRatio == 0)
+            return static_cast<size_t>(std::clamp(value, 0.0, static_cast<double>(buckets - 1)));
+        if (value < low)
+            return 0;
+        const double k = std::floor(std::log(value / low) / logRatio) + 1;
+        return static_cast<size_t>(std::min(k, static_cast<double>(buckets - 1)));
+    }
+
+    // Upper edge of a logarithmic bucket, the value itself for linear ones.
+    double bucketValue(size_t bucket) const {
+        return logRatio == 0 ? static_cast<double>(bucket) : low * std::exp(logRatio * bucket);
+    }
+
+    void evict(size_t row) {
+        uint32_t* rowBuckets = counts.data() + row * buckets;
+        for (size_t b = 0; b < buckets; ++b) {
+            totals[b] -= rowBuckets[b];
+            rowBuckets[b] = 0;
+        }
+        total -= rowCounts[row];
+        sum -= rowSums[row];
+        rowCounts[row] = 0;
+        rowSums[row] = 0;
+        rowMax[row] = 0;
+        if (total == 0)
+            sum = 0;  // Drop accumulated rounding error.
+    }
+
+public:
+    static RollingHistogram logarithmic(double low, double high, size_t bucketsPerOctave,
+        TelemetryClock::duration window = std::chrono::seconds(10)) {
+        const size_t perOctave = std::max<size_t>(bucketsPerOctave, 1);
+        const size_t octaves = static_cast<size_t>(std::ceil(std::log2(std::max(high / low, 2.0))));
+        return RollingHistogram(window, octaves * perOctave + 2, low, std::log(2.0) / perOctave);
+    }
+
+    static RollingHistogram linear(size_t maxValue, TelemetryClock::duration window = std::chrono::seconds(10)) {
+        return RollingHistogram(window, maxValue + 1, 0, 0);
+    }
+
+    // Frame latencies: 0.25 ms to about 16 s in quarter-octave (19%) buckets.
+    static RollingHistogram latencyMs(TelemetryClock::duration window = std::chrono::seconds(10)) {
+        return logarithmic(0.25, 16000, 4, window);
+    }
+
+    void record(double value, TelemetryClock::time_point now) {
+        const size_t row = advance(now);
+        const size_t bucket = bucketOf(std::max(value, 0.0));
+        counts[row * buckets + bucket]++;
+        totals[bucket]++;
+        rowCounts[row]++;
+        rowSums[row] += value;
+        rowMax[row] = std::max(rowMax[row], value);
+        total++;
+        sum += value;
+    }
+
+    // Forget samples that left the window; reads reflect the window as of the last advance or record.
+    size_t advance(TelemetryClock::time_point now) {
+        return window.advance(now, [this](size_t row) { evict(row); });
+    }
+
+    // Nearest-rank percentile, p in [0, 100], at bucket resolution and never above max(); 0 when empty.
+    double percentile(double p) const {
+        if (total == 0)
+            return 0;
+        const uint64_t rank = std::max<uint64_t>(
+            static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * total)), 1);
+        uint64_t seen = 0;
+        for (size_t b = 0; b < buckets; ++b) {
+            seen += totals[b];
+            if (seen >= rank)
+                return std::min(bucketValue(b), max());
+        }
+        return max();
+    }
+
+    double mean() const { return total ? sum / total : 0; }
+    double max() const { return *std::max_element(rowMax.begin(), rowMax.end()); }
+    uint64_t count() const { return total; }
+    double windowSeconds() const { return window.seconds(); }
+};
+
+// Event count over the last `window`, e.g. frames a queue dropped.
+class RollingCounter {
+private:
+    RollingWindow window;
+    std::vector<uint64_t> rowCounts;
+    uint64_t total = 0;
+
+public:
+    explicit RollingCounter(TelemetryClock::duration windowLength = std::chrono::seconds(10))
+        : window(windowLength, kTelemetrySlices), rowCounts(window.rows(), 0) {}
+
+    void add(uint64_t n, TelemetryClock::time_point now) {
+        const size_t row = advance(now);
+        rowCounts[row] += n;
+        total += n;
+    }
+
+    size_t advance(TelemetryClock::time_point now) {
+        return window.advance(now, [this](size_t row) {
+            total -= rowCounts[row];
+            rowCounts[row] = 0;
+        });
+    }
+
+    uint64_t count() const { return total; }
+    double windowSeconds() const { return window.seconds(); }
+};
+
+// What a PipelineTelemetry window holds, in plain numbers.
+struct LatencySummary {
+    uint64_t frames = 0;
+    double p50 = 0, p95 = 0, p99 = 0, max = 0;  // Milliseconds.
+};
+
+struct StageSummary {
+    std::string name;
+    uint64_t dropped = 0;  // Frames the stage's input queue dropped in the window.
+    double meanDepth = 0;
+    double maxDepth = 0;
+};
+
+struct TelemetrySnapshot {
+    double windowSeconds = 0;
+    LatencySummary glassToGlass;  // Camera read to frame shown.
+    LatencySummary inference;     // Camera read to inference done.
+    std::vector<StageSummary> stages;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const LatencySummary& s) {
+    return os << "p50 " << s.p50 << " ms, p95 " << s.p95 << " ms, p99 " << s.p99 << " ms, max " << s.max
+              << " ms over " << s.frames << " frames";
+}
+
+inline std::ostream& operator<<(std::ostream& os, const StageSummary& s) {
+    return os << s.name << " dropped " << s.dropped << ", depth mean " << s.meanDepth << " max " << s.maxDepth;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const TelemetrySnapshot& s) {
+    os << "last " << s.windowSeconds << " s: glass-to-glass " << s.glassToGlass << "; inference " << s.inference;
+    for (const StageSummary& stage : s.stages)
+        os << "; " << stage;
+    return os;
+}
+
+// End-to-end latency and per-stage queue health of a staged pipeline (main.cpp), over a
+// rolling window. Each frame carries its capture time through the stages; the last stage
+// reports it with recordFrame(). sampleStage() takes a stage input queue's running drop
+// counter and current depth (SpscQueue::dropped() / size()), once per shown frame.
+// Not thread-safe: record and read from one thread, e.g. the render loop.
+class PipelineTelemetry {
+private:
+    struct Stage {
+        std::string name;
+        RollingCounter dropped;
+        RollingHistogram depth;
+        uint64_t droppedBefore = 0;
+    };
+
+    RollingHistogram glassToGlass;
+    RollingHistogram inference;
+    std::vector<Stage> stages;
+
+    static double milliseconds(TelemetryClock::time_point start, TelemetryClock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    static LatencySummary summarize(const RollingHistogram& h) {
+        return { h.count(), h.percentile(50), h.percentile(95), h.percentile(99), h.max() };
+    }
+
+public:
+    PipelineTelemetry(const std::vector<std::string>& stageNames, size_t maxQueueDepth,
+        TelemetryClock::duration window = std::chrono::seconds(10))
+        : glassToGlass(RollingHistogram::latencyMs(window)), inference(RollingHistogram::latencyMs(window)) {
+        stages.reserve(stageNames.size());
+        for (const std::string& name : stageNames)
+            stages.push_back({ name, RollingCounter(window), RollingHistogram::linear(maxQueueDepth, window) });
+    }
+
+    void recordFrame(TelemetryClock::time_point captured, TelemetryClock::time_point inferred,
+        TelemetryClock::time_point shown) {
+        glassToGlass.record(milliseconds(captured, shown), shown);
+        inference.record(milliseconds(captured, inferred), shown);
+    }
+
+    void sampleStage(size_t stage, uint64_t droppedTotal, size_t depth, TelemetryClock::time_point now) {
+        Stage& s = stages[stage];
+        s.dropped.add(droppedTotal - s.droppedBefore, now);
+        s.droppedBefore = droppedTotal;
+        s.depth.record(static_cast<double>(depth), now);
+    }
+
+    TelemetrySnapshot snapshot(TelemetryClock::time_point now) {
+        glassToGlass.advance(now);
+        inference.advance(now);
+        TelemetrySnapshot snap;
+        snap.windowSeconds = glassToGlass.windowSeconds();
+        snap.glassToGlass = summarize(glassToGlass);
+        snap.inference = summarize(inference);
+        snap.stages.reserve(stages.size());
+        for (Stage& s : stages) {
+            s.dropped.advance(now);
+            s.depth.advance(now);
+            snap.stages.push_back({ s.name, s.dropped.count(), s.depth.mean(), s.depth.max() });
+        }
+        return snap;
+    }
+
+    const RollingHistogram& glassToGlassMs() const { return glassToGlass; }
+    const RollingHistogram& inferenceMs() const { return inference; }
+};
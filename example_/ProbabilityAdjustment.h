@@ -5,8 +5,15 @@
 //  Created by Sertan Avdan on 2025-03-26.
 //
 
+#pragma once
+
 #include <vector>
 #include <numeric>
+#include <span>
+#include <array>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
 
 class EmotionProbabilityAdjuster {
 private:
@@ -18,18 +25,72 @@ public:
     EmotionProbabilityAdjuster(float boostFactor = 1.5f, int neutralIndex = 3)
         : boostFactor(boostFactor), neutralIndex(neutralIndex) {}
 
-    // Adjust the probabilities by boosting the neutral class and re-normalizing.
-    std::vector<float> adjust(const std::vector<float>& probabilities) {
-        std::vector<float> adjusted = probabilities;
-        if (adjusted.size() > static_cast<size_t>(neutralIndex)) {
-            adjusted[neutralIndex] *= boostFactor;
+    // Adjust the probabilities in place by boosting the neutral class and re-normalizing.
+    void adjust(std::span<float> probabilities) const {
+        if (probabilities.size() > static_cast<size_t>(neutralIndex)) {
+            probabilities[neutralIndex] *= boostFactor;
         }
         // Re-normalize the probabilities so they sum to 1.
-        float sum = std::accumulate(adjusted.begin(), adjusted.end(), 0.0f);
+        float sum = std::accumulate(probabilities.begin(), probabilities.end(), 0.0f);
         if (sum > 0) {
-            for (auto &p : adjusted)
+            for (auto &p : probabilities)
                 p /= sum;
         }
+    }
+
+    // Adjust a contiguous faces x numClasses buffer (row-major, one row per face) in place.
+    void adjustBatch(std::span<float> rows, size_t numClasses) const {
+        if (numClasses == 0) return;
+        for (size_t offset = 0; offset + numClasses <= rows.size(); offset += numClasses)
+            adjust(rows.subspan(offset, numClasses));
+    }
+
+    // Copying variant kept for callers that still need the input untouched.
+    std::vector<float> adjust(const std::vector<float>& probabilities) const {
+        std::vector<float> adjusted = probabilities;
+        adjust(std::span<float>(adjusted));
         return adjusted;
     }
 };
+
+// Compile-time specialized adjuster for a fixed class layout (e.g. the 7-class FER models).
+// The whole frame lives in a std::array and the boost + re-normalize step is unrolled by
+// fold expressions, so the compiler can keep every probability in registers.
+template <size_t NumClasses, size_t NeutralIndex>
+class FixedEmotionProbabilityAdjuster {
+    static_assert(NeutralIndex < NumClasses, "Neutral index must address one of the classes.");
+
+private:
+    float boostFactor;  // Factor to boost the neutral probability.
+
+public:
+    using Probabilities = std::array<float, NumClasses>;
+
+    constexpr explicit FixedEmotionProbabilityAdjuster(float boostFactor = 1.5f)
+        : boostFactor(boostFactor) {}
+
+    // Adjust a frame held by value; same result as EmotionProbabilityAdjuster::adjust.
+    [[nodiscard]] constexpr Probabilities adjust(Probabilities probabilities) const {
+        return adjustUnrolled(probabilities, std::make_index_sequence<NumClasses>{});
+    }
+
+    // Adjust a frame stored elsewhere (e.g. the predictor's output) in place.
+    void adjust(std::span<float, NumClasses> probabilities) const {
+        Probabilities frame;
+        std::copy_n(probabilities.begin(), NumClasses, frame.begin());
+        frame = adjust(frame);
+        std::copy_n(frame.begin(), NumClasses, probabilities.begin());
+    }
+
+private:
+    template <size_t... I>
+    constexpr Probabilities adjustUnrolled(Probabilities p, std::index_sequence<I...>) const {
+        std::get<NeutralIndex>(p) *= boostFactor;
+        // Left fold keeps std::accumulate's summation order, so results match bit for bit.
+        const float sum = (0.0f + ... + p[I]);
+        if (sum > 0) {
+            ((p[I] /= sum), ...);
+        }
+        return p;
+    }
+};
@@ -0,0 +1,213 @@
+//
+//  ProbabilityGraph.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include "ProbabilityHistory.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Incremental renderer for the per-class probability line graphs.
+// Axes and labels are drawn once into the canvas. Each class's plot area then scrolls left
+// by a whole number of pixels per new sample, and only the newly arrived segments are
+// rasterized, so a frame costs O(new samples) line draws instead of O(history).
+// The graph redraws fully when the source changes (another face), the history was reset
+// or too many samples arrived to scroll. Samples are `step` pixels apart; with more history
+// than plot pixels only the newest visibleSamples() are shown.
+//
+// A history with downsampled tiers (ProbabilityHistory lodLevels) is drawn as a long
+// timeline instead: the plot is shared between the tiers, newest on the right, and each tier
+// continues where the finer one to its right ends, so a point of tier k spans 2^k pushes and
+// the same width covers far more history. Faint vertical lines mark the tier boundaries.
+// The time axis changes scale along the plot, so such histories always redraw in full.
+class ProbabilityGraph {
+private:
+    static constexpr int margin = 5;
+    static constexpr int labelBand = 14;  // Kept clear of the plot so labels never scroll.
+
+    std::vector<cv::Scalar> colors;
+    cv::Mat canvas;
+    std::vector<cv::Rect> plots;  // Per class, inside the axes.
+    int step = 1;
+    size_t visible = 1;
+
+    bool valid = false;
+    bool fullRedraw = false;
+    uint64_t drawnSource = 0;
+    size_t drawnPushed = 0;
+    size_t drawnFirst = 0;
+
+    // Timeline mode: the points on screen, oldest first, and where each tier starts.
+    struct TimelinePoint {
+        size_t level;
+        size_t frame;
+    };
+    std::vector<TimelinePoint> timeline;
+    std::vector<size_t> tierStarts;
+
+    // First push number on screen.
+    size_t firstVisible(const ProbabilityHistory& history) const {
+        return history.pushed() - std::min(history.size(), visible);
+    }
+
+    int yOf(const cv::Rect& plot, float p) const {
+        return static_cast<int>((plot.height - 1) * (1.0f - std::clamp(p, 0.0f, 1.0f)));
+    }
+
+    // Segment from push n to push n + 1, in plot coordinates relative to push `first`.
+    void drawSegment(const ProbabilityHistory& history, size_t n, size_t first) {
+        const size_t oldest = history.pushed() - history.size();
+        for (size_t c = 0; c < plots.size(); ++c) {
+            cv::Mat plot = canvas(plots[c]);
+            const cv::Point p0(static_cast<int>(n - first) * step, yOf(plots[c], history.at(n - oldest, c)));
+            const cv::Point p1(static_cast<int>(n + 1 - first) * step, yOf(plots[c], history.at(n + 1 - oldest, c)));
+            cv::line(plot, p0, p1, colors[c % colors.size()], 1, cv::LINE_AA);
+        }
+    }
+
+    // Shift every plot area left by dx pixels and clear the vacated columns.
+    void scroll(int dx) {
+        const size_t pixel = canvas.elemSize();
+        for (const cv::Rect& plot : plots) {
+            const size_t kept = static_cast<size_t>(plot.width - dx) * pixel;
+            for (int y = plot.y; y < plot.y + plot.height; ++y) {
+                uint8_t* row = canvas.ptr<uint8_t>(y) + static_cast<size_t>(plot.x) * pixel;
+                std::memmove(row, row + static_cast<size_t>(dx) * pixel, kept);
+                std::memset(row + kept, 255, static_cast<size_t>(dx) * pixel);
+            }
+        }
+    }
+
+    // Up to `visible` points, taking an equal share from every tier in turn (the coarsest
+    // takes what is left), newest first, then reversed into time order.
+    void buildTimeline(const ProbabilityHistory& history) {
+        timeline.clear();
+        tierStarts.clear();
+        const size_t levels = history.levels();
+        const size_t share = std::max<size_t>(visible / levels, 2);
+        size_t boundary = history.pushed();  // Oldest push already covered by finer tiers.
+        for (size_t level = 0; level < levels && timeline.size() < visible; ++level) {
+            const size_t span = size_t(1) << level;
+            const size_t oldest = history.pushed(level) - history.size(level);
+            const size_t newest = std::min(history.pushed(level), boundary / span);  // One past, absolute.
+            if (newest <= oldest)
+                continue;
+            const size_t room = visible - timeline.size();
+            const size_t count = std::min({ newest - oldest, level + 1 == levels ? room : share, room });
+            for (size_t a = newest; a > newest - count; --a)
+                timeline.push_back({ level, a - 1 - oldest });
+            tierStarts.push_back(timeline.size());
+            boundary = (newest - count) * span;
+        }
+        std::reverse(timeline.begin(), timeline.end());
+        for (size_t& start : tierStarts)
+            start = timeline.size() - start;
+    }
+
+    void redrawTimeline(const ProbabilityHistory& history) {
+        for (const cv::Rect& plot : plots)
+            canvas(plot).setTo(cv::Scalar(255, 255, 255));
+        buildTimeline(history);
+        for (size_t c = 0; c < plots.size(); ++c) {
+            cv::Mat plot = canvas(plots[c]);
+            for (size_t start : tierStarts) {
+                // Every tier but the oldest shown starts at a boundary with a coarser one.
+                if (start > 0) {
+                    const int x = static_cast<int>(start) * step;
+                    cv::line(plot, cv::Point(x, 0), cv::Point(x, plots[c].height - 1), cv::Scalar(220, 220, 220), 1);
+                }
+            }
+            for (size_t i = 0; i + 1 < timeline.size(); ++i) {
+                const TimelinePoint& a = timeline[i];
+                const TimelinePoint& b = timeline[i + 1];
+                const cv::Point p0(static_cast<int>(i) * step, yOf(plots[c], history.at(a.level, a.frame, c)));
+                const cv::Point p1(static_cast<int>(i + 1) * step, yOf(plots[c], history.at(b.level, b.frame, c)));
+                cv::line(plot, p0, p1, colors[c % colors.size()], 1, cv::LINE_AA);
+            }
+        }
+    }
+
+    void redraw(const ProbabilityHistory& history) {
+        for (const cv::Rect& plot : plots)
+            canvas(plot).setTo(cv::Scalar(255, 255, 255));
+        const size_t first = firstVisible(history);
+        for (size_t n = first; n + 1 < history.pushed(); ++n)
+            drawSegment(history, n, first);
+    }
+
+public:
+    ProbabilityGraph(const std::vector<std::string>& classes, std::vector<cv::Scalar> classColors,
+        size_t historyCapacity, cv::Size size = { 1600, 400 })
+        : colors(std::move(classColors)) {
+        if (colors.empty())
+            colors.emplace_back(0, 0, 0);
+        canvas = cv::Mat(size.height, size.width, CV_8UC3, cv::Scalar(255, 255, 255));
+        const int sectionWidth = size.width / static_cast<int>(std::max<size_t>(classes.size(), 1));
+        const int plotWidth = std::max(sectionWidth - 2 * margin - 1, 2);
+        const int plotHeight = std::max(size.height - 2 * margin - labelBand, 2);
+        const size_t intervals = std::max<size_t>(historyCapacity, 2) - 1;
+        step = std::max(1, static_cast<int>((plotWidth - 1) / intervals));
+        visible = std::min(intervals, static_cast<size_t>((plotWidth - 1) / step)) + 1;
+
+        for (size_t j = 0; j < classes.size(); j++) {
+            const int sectionStart = static_cast<int>(j) * sectionWidth;
+            cv::line(canvas, cv::Point(sectionStart + margin, margin), cv::Point(sectionStart + margin, size.height - margin),
+                cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+            cv::line(canvas, cv::Point(sectionStart + margin, size.height - margin),
+                cv::Point(sectionStart + sectionWidth - margin, size.height - margin), cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+            cv::putText(canvas, classes[j], cv::Point(sectionStart + margin + 5, margin + 10),
+                cv::FONT_HERSHEY_PLAIN, 1, cv::Scalar(0, 0, 0), 1, cv::LINE_AA);
+            plots.emplace_back(sectionStart + margin + 1, margin + labelBand, plotWidth, plotHeight);
+        }
+    }
+
+    // Bring the canvas up to date with `history`; sourceId identifies whose history it is.
+    const cv::Mat& render(const ProbabilityHistory& history, uint64_t sourceId = 0) {
+        fullRedraw = false;
+        const size_t pushed = history.pushed();
+        if (plots.empty() || (valid && sourceId == drawnSource && pushed == drawnPushed))
+            return canvas;
+
+        if (history.levels() > 1) {
+            redrawTimeline(history);
+            fullRedraw = true;
+            valid = !history.empty();
+            drawnSource = sourceId;
+            drawnPushed = pushed;
+            return canvas;
+        }
+
+        const size_t first = firstVisible(history);
+        const bool incremental = valid && sourceId == drawnSource && pushed > drawnPushed
+            && pushed - drawnPushed < visible && first >= drawnFirst;
+        const int dx = incremental ? static_cast<int>(first - drawnFirst) * step : 0;
+        if (!incremental || dx >= plots.front().width) {
+            redraw(history);
+            fullRedraw = true;
+        } else {
+            if (dx > 0)
+                scroll(dx);
+            for (size_t n = std::max(drawnPushed - 1, first); n + 1 < pushed; ++n)
+                drawSegment(history, n, first);
+        }
+        valid = !history.empty();
+        drawnSource = sourceId;
+        drawnPushed = pushed;
+        drawnFirst = first;
+        return canvas;
+    }
+
+    const cv::Mat& image() const { return canvas; }
+    bool lastWasFullRedraw() const { return fullRedraw; }
+    int sampleStep() const { return step; }
+    size_t visibleSamples() const { return visible; }
+
+    // Force a full redraw on the next render().
+    void invalidate() { valid = false; }
+};
@@ -0,0 +1,181 @@
+//
+//  ProbabilityHistory.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Sample storage of a ProbabilityHistory. The fixed-point formats store round(p * max) for
+// p clamped to [0, 1], so a stored value is within half a step of the pushed one:
+// 1 / 510 (about 0.002) for fixed8, 1 / 131070 for fixed16.
+enum class HistoryPrecision { float32, fixed16, fixed8 };
+
+inline float historyQuantizationError(HistoryPrecision precision) {
+    switch (precision) {
+    case HistoryPrecision::fixed16: return 0.5f / 65535.0f;
+    case HistoryPrecision::fixed8: return 0.5f / 255.0f;
+    default: return 0.0f;
+    }
+}
+
+// Fixed-capacity probability history in structure-of-arrays layout.
+// One flat numClasses x capacity allocation holds every sample; class c owns row c,
+// so a per-class scan walks contiguous memory. push() is O(1) and overwrites the
+// oldest frame once the buffer is full. Frame indices run from 0 (oldest) to size() - 1.
+//
+// Compact mode, for long timelines: fixed16 / fixed8 precision cuts the footprint to a half
+// or a quarter, and `lodLevels` adds downsampled tiers for older data, mip-map style. Level
+// k keeps `capacity` frames that are each the mean of 2^k consecutive pushes, so levels
+// 0..L together cover capacity * (2^(L+1) - 1) pushes for (L + 1) x the level-0 storage.
+// Means are taken in float before quantizing, so every tier has the same error bound.
+class ProbabilityHistory {
+private:
+    struct Ring {
+        size_t oldest = 0;
+        size_t count = 0;
+        size_t total = 0;  // Pushes since construction or reset().
+    };
+
+    // Only the vector for `precision` is allocated. Level l owns rows [l * classes, (l + 1) * classes).
+    std::vector<float> samples;  // Row-major: samples[(l * classes + c) * cap + slot].
+    std::vector<uint16_t> samples16;
+    std::vector<uint8_t> samples8;
+    std::vector<Ring> rings;     // One per level; rings[0] is full rate.
+    std::vector<float> pending;  // Per level >= 1: first frame of the pair being averaged.
+    std::vector<uint8_t> pendingFull;
+    std::vector<float> merged;   // Scratch for the frame carried to the next level.
+    HistoryPrecision precision;
+    size_t classes;
+    size_t cap;
+
+    size_t slotOf(const Ring& ring, size_t frame) const { return (ring.oldest + frame) % cap; }
+
+    float load(size_t index) const {
+        switch (precision) {
+        case HistoryPrecision::fixed16: return samples16[index] * (1.0f / 65535.0f);
+        case HistoryPrecision::fixed8: return samples8[index] * (1.0f / 255.0f);
+        default: return samples[index];
+        }
+    }
+
+    void store(size_t index, float value) {
+        switch (precision) {
+        case HistoryPrecision::fixed16:
+            samples16[index] = static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+            break;
+        case HistoryPrecision::fixed8:
+            samples8[index] = static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+            break;
+        default:
+            samples[index] = value;
+        }
+    }
+
+    void pushLevel(size_t level, std::span<const float> frame) {
+        Ring& ring = rings[level];
+        size_t slot;
+        if (ring.count < cap) {
+            slot = slotOf(ring, ring.count);
+            ring.count++;
+        } else {
+            slot = ring.oldest;
+            ring.oldest = (ring.oldest + 1) % cap;
+        }
+        const size_t n = std::min(classes, frame.size());
+        for (size_t c = 0; c < n; ++c)
+            store((level * classes + c) * cap + slot, frame[c]);
+        ring.total++;
+    }
+
+public:
+    ProbabilityHistory(size_t numClasses, size_t capacity, HistoryPrecision precision = HistoryPrecision::float32,
+        size_t lodLevels = 0)
+        : rings(lodLevels + 1), pending(lodLevels * numClasses, 0.0f), pendingFull(lodLevels + 1, 0),
+          merged(lodLevels ? numClasses : 0), precision(precision), classes(numClasses),
+          cap(std::max<size_t>(capacity, 1)) {
+        const size_t total = rings.size() * classes * cap;
+        switch (precision) {
+        case HistoryPrecision::fixed16: samples16.assign(total, 0); break;
+        case HistoryPrecision::fixed8: samples8.assign(total, 0); break;
+        default: samples.assign(total, 0.0f);
+        }
+    }
+
+    // Append one frame of numClasses probabilities.
+    void push(std::span<const float> frame) {
+        pushLevel(0, frame);
+        // Every second frame of a level completes one frame of the next level.
+        std::span<const float> carry = frame;
+        const size_t n = std::min(classes, frame.size());
+        for (size_t level = 1; level < rings.size(); ++level) {
+            float* first = pending.data() + (level - 1) * classes;
+            if (!pendingFull[level]) {
+                std::copy_n(carry.begin(), n, first);
+                pendingFull[level] = 1;
+                break;
+            }
+            for (size_t c = 0; c < n; ++c)
+                merged[c] = 0.5f * (first[c] + carry[c]);
+            pendingFull[level] = 0;
+            carry = std::span<const float>(merged.data(), n);
+            pushLevel(level, carry);
+        }
+    }
+
+    float at(size_t frame, size_t classIndex) const { return at(0, frame, classIndex); }
+
+    // Frame `frame` (0 = oldest) of a level; each frame of level k averages 2^k pushes.
+    float at(size_t level, size_t frame, size_t classIndex) const {
+        return load((level * classes + classIndex) * cap + slotOf(rings[level], frame));
+    }
+
+    // Newest sample of a class; only valid when !empty().
+    float latest(size_t classIndex) const { return at(rings[0].count - 1, classIndex); }
+
+    // The newest frame as stored, i.e. after quantization in compact mode.
+    void latestFrame(std::span<float> out) const {
+        for (size_t c = 0; c < std::min(classes, out.size()); ++c)
+            out[c] = latest(c);
+    }
+
+    // A class's samples, oldest to newest, as at most two contiguous runs (split at the wrap).
+    // Level 0 of float32 histories only; compact histories return empty runs, read them with at().
+    std::pair<std::span<const float>, std::span<const float>> series(size_t classIndex) const {
+        if (precision != HistoryPrecision::float32)
+            return {};
+        const Ring& ring = rings[0];
+        const float* row = samples.data() + classIndex * cap;
+        const size_t firstRun = std::min(ring.count, cap - ring.oldest);
+        return { std::span<const float>(row + ring.oldest, firstRun),
+                 std::span<const float>(row, ring.count - firstRun) };
+    }
+
+    size_t size() const { return rings[0].count; }
+    size_t size(size_t level) const { return rings[level].count; }
+    size_t capacity() const { return cap; }
+    size_t numClasses() const { return classes; }
+    size_t levels() const { return rings.size(); }
+    HistoryPrecision samplePrecision() const { return precision; }
+    bool empty() const { return rings[0].count == 0; }
+    bool full() const { return rings[0].count == cap; }
+    // Monotonic push count; the oldest retained frame is push number pushed() - size().
+    size_t pushed() const { return rings[0].total; }
+    size_t pushed(size_t level) const { return rings[level].total; }
+    // Bytes of sample storage across every level.
+    size_t storageBytes() const {
+        return samples.size() * sizeof(float) + samples16.size() * sizeof(uint16_t) + samples8.size();
+    }
+
+    void reset() {
+        std::fill(rings.begin(), rings.end(), Ring{});
+        std::fill(pendingFull.begin(), pendingFull.end(), 0);
+    }
+};
@@ -0,0 +1,93 @@
+//
+//  RenderScheduler.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include "TripleBuffer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <utility>
+
+// Redraws on its own thread at most maxFps times per second, and only when the state changed.
+// The producer (the inference stage) publish()es the newest state through a TripleBuffer and
+// never waits: states published between two redraws are coalesced into the newest one, so the
+// redraw rate follows min(update rate, maxFps) rather than the inference rate.
+// The render callback runs on the scheduler's thread.
+template<typename State>
+class RenderScheduler {
+private:
+    TripleBuffer<State> states;
+    std::function<void(const State&)> render;
+    std::chrono::steady_clock::duration interval;
+    alignas(64) std::atomic<uint32_t> signal{ 0 };  // Bumped on publish and stop to wake the thread.
+    std::atomic<bool> stopping{ false };
+    std::atomic<uint64_t> publishedCount{ 0 };
+    std::atomic<uint64_t> renderedCount{ 0 };
+    std::thread worker;
+
+    void run() {
+        auto nextRender = std::chrono::steady_clock::now();
+        for (;;) {
+            const uint32_t seen = signal.load(std::memory_order_acquire);
+            if (stopping.load(std::memory_order_acquire))
+                return;
+            if (!states.update()) {
+                signal.wait(seen, std::memory_order_acquire);
+                continue;
+            }
+            render(states.readBuffer());
+            renderedCount.fetch_add(1, std::memory_order_relaxed);
+            // Rate cap: the next redraw waits out the interval even if newer states arrive.
+            nextRender = std::max(nextRender + interval, std::chrono::steady_clock::now());
+            std::this_thread::sleep_until(nextRender);
+        }
+    }
+
+    void wake() {
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_one();
+    }
+
+public:
+    // maxFps <= 0 means no cap (redraw as soon as a new state arrives).
+    RenderScheduler(double maxFps, std::function<void(const State&)> renderState)
+        : render(std::move(renderState)),
+          interval(maxFps > 0 ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                    std::chrono::duration<double>(1.0 / maxFps))
+                              : std::chrono::steady_clock::duration::zero()),
+          worker([this] { run(); }) {}
+
+    ~RenderScheduler() { stop(); }
+
+    RenderScheduler(const RenderScheduler&) = delete;
+    RenderScheduler& operator=(const RenderScheduler&) = delete;
+
+    // Producer side, from a single thread. `fill` writes the state in place (reusing the
+    // slot's storage) and must overwrite everything the render reads.
+    template<typename Fill>
+    void publish(Fill&& fill) {
+        fill(states.writeBuffer());
+        states.publish();
+        publishedCount.fetch_add(1, std::memory_order_relaxed);
+        wake();
+    }
+
+    // Finish the redraw in progress and join the thread; later publishes are never drawn.
+    void stop() {
+        stopping.store(true, std::memory_order_release);
+        wake();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    uint64_t published() const { return publishedCount.load(std::memory_order_relaxed); }
+    uint64_t rendered() const { return renderedCount.load(std::memory_order_relaxed); }
+    // Published states that were superseded before being drawn.
+    uint64_t coalesced() const { return published() - rendered(); }
+};
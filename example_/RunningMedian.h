@@ -0,0 +1,186 @@
+//
+//  RunningMedian.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Sliding-window median of a single stream, updated in O(log W) per push.
+// Window values live in a ring of slots; two indexed heaps hold the lower and upper
+// halves and track each slot's position, so the oldest value can be replaced in place
+// without searching. The median is the element at index size() / 2 of the sorted window,
+// matching the nth_element selection the smoothing chain used before.
+class SlidingMedian {
+private:
+    // Binary heap of slot ids ordered by the slot's value (max-heap for the lower half).
+    struct IndexedHeap {
+        std::vector<uint32_t> slots;
+        bool isMax = false;
+
+        bool above(const std::vector<float>& values, uint32_t a, uint32_t b) const {
+            return isMax ? values[a] > values[b] : values[a] < values[b];
+        }
+
+        void place(std::vector<uint32_t>& positions, size_t i, uint32_t slot) {
+            slots[i] = slot;
+            positions[slot] = static_cast<uint32_t>(i);
+        }
+
+        void siftUp(const std::vector<float>& values, std::vector<uint32_t>& positions, size_t i) {
+            uint32_t slot = slots[i];
+            while (i > 0) {
+                size_t parent = (i - 1) / 2;
+                if (!above(values, slot, slots[parent])) break;
+                place(positions, i, slots[parent]);
+                i = parent;
+            }
+            place(positions, i, slot);
+        }
+
+        void siftDown(const std::vector<float>& values, std::vector<uint32_t>& positions, size_t i) {
+            uint32_t slot = slots[i];
+            size_t n = slots.size();
+            while (true) {
+                size_t child = 2 * i + 1;
+                if (child >= n) break;
+                if (child + 1 < n && above(values, slots[child + 1], slots[child])) child++;
+                if (!above(values, slots[child], slot)) break;
+                place(positions, i, slots[child]);
+                i = child;
+            }
+            place(positions, i, slot);
+        }
+
+        void push(const std::vector<float>& values, std::vector<uint32_t>& positions, uint32_t slot) {
+            slots.push_back(slot);
+            siftUp(values, positions, slots.size() - 1);
+        }
+
+        uint32_t pop(const std::vector<float>& values, std::vector<uint32_t>& positions) {
+            uint32_t top = slots.front();
+            uint32_t last = slots.back();
+            slots.pop_back();
+            if (!slots.empty()) {
+                place(positions, 0, last);
+                siftDown(values, positions, 0);
+            }
+            return top;
+        }
+    };
+
+    std::vector<float> values;       // Window values indexed by slot.
+    std::vector<uint32_t> positions; // Index of each slot inside its heap.
+    std::vector<uint8_t> inLower;    // Which heap currently owns each slot.
+    IndexedHeap lower;               // Max-heap: smaller half, size() / 2 entries.
+    IndexedHeap upper;               // Min-heap: larger half, top is the median.
+    size_t window;
+    size_t oldest = 0;
+    size_t count = 0;
+
+    void insert(IndexedHeap& heap, uint32_t slot) {
+        inLower[slot] = (&heap == &lower);
+        heap.push(values, positions, slot);
+    }
+
+    void move(IndexedHeap& from, IndexedHeap& to) {
+        insert(to, from.pop(values, positions));
+    }
+
+    void rebalance() {
+        if (lower.slots.size() > count / 2) move(lower, upper);
+        if (upper.slots.size() > count - count / 2) move(upper, lower);
+    }
+
+public:
+    explicit SlidingMedian(size_t window = 1)
+        : values(window > 0 ? window : 1), positions(values.size()), inLower(values.size()),
+          window(values.size()) {
+        lower.isMax = true;
+        lower.slots.reserve(this->window);
+        upper.slots.reserve(this->window);
+    }
+
+    // Add a value, evicting the oldest one once the window is full.
+    void push(float value) {
+        if (count < window) {
+            auto slot = static_cast<uint32_t>((oldest + count) % window);
+            values[slot] = value;
+            count++;
+            bool belowMedian = !upper.slots.empty() && value < values[upper.slots.front()];
+            insert(belowMedian ? lower : upper, slot);
+            rebalance();
+            return;
+        }
+
+        // Window full: overwrite the oldest slot in place and restore both heap orders.
+        auto slot = static_cast<uint32_t>(oldest);
+        oldest = (oldest + 1) % window;
+        values[slot] = value;
+        IndexedHeap& owner = inLower[slot] ? lower : upper;
+        owner.siftUp(values, positions, positions[slot]);
+        owner.siftDown(values, positions, positions[slot]);
+
+        if (!lower.slots.empty() && values[lower.slots.front()] > values[upper.slots.front()]) {
+            uint32_t lowTop = lower.slots.front();
+            uint32_t highTop = upper.slots.front();
+            lower.place(positions, 0, highTop);
+            upper.place(positions, 0, lowTop);
+            std::swap(inLower[lowTop], inLower[highTop]);
+            lower.siftDown(values, positions, 0);
+            upper.siftDown(values, positions, 0);
+        }
+    }
+
+    // Median of the current window; only valid when size() > 0.
+    float median() const { return values[upper.slots.front()]; }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return window; }
+
+    void reset() {
+        lower.slots.clear();
+        upper.slots.clear();
+        oldest = 0;
+        count = 0;
+    }
+};
+
+// Per-class running median over the last `window` probability frames.
+class RunningMedian {
+private:
+    std::vector<SlidingMedian> perClass;
+
+public:
+    // Built in place so every heap keeps its reserved capacity (no growth after warm-up).
+    RunningMedian(size_t numClasses, size_t window) {
+        perClass.reserve(numClasses);
+        for (size_t c = 0; c < numClasses; ++c)
+            perClass.emplace_back(window);
+    }
+
+    // Push one frame of numClasses probabilities.
+    void push(std::span<const float> frame) {
+        for (size_t c = 0; c < perClass.size() && c < frame.size(); ++c)
+            perClass[c].push(frame[c]);
+    }
+
+    // Write the per-class medians into `out`; leaves it untouched while no frame was pushed.
+    void median(std::span<float> out) const {
+        if (empty()) return;
+        for (size_t c = 0; c < perClass.size() && c < out.size(); ++c)
+            out[c] = perClass[c].median();
+    }
+
+    bool empty() const { return perClass.empty() || perClass.front().size() == 0; }
+    size_t size() const { return perClass.empty() ? 0 : perClass.front().size(); }
+
+    void reset() {
+        for (auto& m : perClass) m.reset();
+    }
+};
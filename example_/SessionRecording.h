@@ -0,0 +1,243 @@
+//
+//  SessionRecording.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+// Append-only binary session log: per frame and face, the face rectangle, raw model
+// probabilities and smoothed outputs, so smoothing experiments can replay a session instead
+// of recapturing video.
+//
+// Layout (little endian, no padding between records):
+//   SessionHeader (64 bytes)
+//   records, each header.recordSize bytes:
+//     uint64 timestampNs   since header.startTimeNs
+//     uint32 frameIndex
+//     uint32 trackId
+//     float  x, y, width, height   pixels, or 0 ... 1 of the frame with kSessionNormalizedRects
+//     raw[numClasses], smoothed[numClasses]   float32, or float16 with kSessionFloat16
+//     zero padding to a multiple of 8 bytes
+// A writer that stops early leaves at most one partial record at the end; readers ignore it.
+// Written by SessionWriter here and by SessionRecorder in Core/SessionRecorder.swift.
+
+#include "Float16.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr uint32_t kSessionMagic = 0x53524546;  // "FERS"
+constexpr uint16_t kSessionVersion = 1;
+constexpr uint16_t kSessionFloat16 = 1 << 0;     // Probabilities stored as IEEE half.
+constexpr uint16_t kSessionNormalizedRects = 1 << 1;  // Face rects in Vision's normalized coordinates (iOS).
+constexpr size_t kSessionRecordFixedBytes = 32;  // timestamp + frame + track + rect.
+
+struct SessionHeader {
+    uint32_t magic = kSessionMagic;
+    uint16_t version = kSessionVersion;
+    uint16_t flags = 0;
+    uint16_t numClasses = 0;
+    uint16_t recordSize = 0;
+    uint32_t reserved0 = 0;
+    uint64_t startTimeNs = 0;  // Wall-clock time of the first frame, ns since the Unix epoch.
+    uint8_t reserved[40] = {};
+};
+static_assert(sizeof(SessionHeader) == 64, "SessionHeader must stay 64 bytes");
+static_assert(std::endian::native == std::endian::little, "Session files are little endian");
+
+inline size_t sessionRecordSize(size_t numClasses, bool float16) {
+    const size_t bytes = kSessionRecordFixedBytes + 2 * numClasses * (float16 ? 2 : 4);
+    return (bytes + 7) & ~size_t{ 7 };
+}
+
+struct SessionRect {
+    float x = 0, y = 0, width = 0, height = 0;
+};
+
+// Streams records to a file through a stdio buffer. The record scratch is sized once in the
+// constructor, so append() does not allocate.
+class SessionWriter {
+private:
+    std::FILE* file = nullptr;
+    SessionHeader header;
+    std::vector<uint8_t> scratch;
+    std::vector<char> streamBuffer;
+    uint64_t written = 0;
+
+    void putProbabilities(uint8_t* dst, std::span<const float> values) const {
+        const bool half = header.flags & kSessionFloat16;
+        for (size_t c = 0; c < header.numClasses; ++c) {
+            const float v = c < values.size() ? values[c] : 0.0f;
+            if (half) {
+                const uint16_t h = floatToHalf(v);
+                std::memcpy(dst + c * 2, &h, 2);
+            } else {
+                std::memcpy(dst + c * 4, &v, 4);
+            }
+        }
+    }
+
+public:
+    SessionWriter(const std::string& path, size_t numClasses, bool float16 = false, uint64_t startTimeNs = 0,
+        size_t bufferBytes = 1 << 20)
+        : scratch(sessionRecordSize(numClasses, float16), 0), streamBuffer(bufferBytes) {
+        header.flags = float16 ? kSessionFloat16 : 0;
+        header.numClasses = static_cast<uint16_t>(numClasses);
+        header.recordSize = static_cast<uint16_t>(scratch.size());
+        header.startTimeNs = startTimeNs;
+        file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+            return;
+        std::setvbuf(file, streamBuffer.data(), _IOFBF, streamBuffer.size());
+        if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+            std::fclose(file);
+            file = nullptr;
+        }
+    }
+
+    ~SessionWriter() { close(); }
+
+    SessionWriter(const SessionWriter&) = delete;
+    SessionWriter& operator=(const SessionWriter&) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+    uint64_t recordCount() const { return written; }
+
+    bool append(uint64_t timestampNs, uint32_t frameIndex, uint32_t trackId, const SessionRect& rect,
+        std::span<const float> raw, std::span<const float> smoothed) {
+        if (file == nullptr)
+            return false;
+        uint8_t* p = scratch.data();
+        std::memcpy(p, &timestampNs, 8);
+        std::memcpy(p + 8, &frameIndex, 4);
+        std::memcpy(p + 12, &trackId, 4);
+        std::memcpy(p + 16, &rect, sizeof(SessionRect));
+        const size_t probabilityBytes = header.numClasses * ((header.flags & kSessionFloat16) ? 2 : 4);
+        putProbabilities(p + kSessionRecordFixedBytes, raw);
+        putProbabilities(p + kSessionRecordFixedBytes + probabilityBytes, smoothed);
+        if (std::fwrite(p, scratch.size(), 1, file) != 1)
+            return false;
+        written++;
+        return true;
+    }
+
+    // Push buffered records to the OS, e.g. so a reader can follow a live session.
+    void flush() {
+        if (file != nullptr)
+            std::fflush(file);
+    }
+
+    void close() {
+        if (file != nullptr) {
+            std::fclose(file);
+            file = nullptr;
+        }
+    }
+};
+
+// One record inside a mapped session; reads straight from the mapping.
+class SessionRecordView {
+private:
+    const uint8_t* data;
+    const SessionHeader* header;
+
+    template<typename T>
+    T read(size_t offset) const {
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+
+    float probability(size_t offset, size_t classIndex) const {
+        if (header->flags & kSessionFloat16)
+            return halfToFloat(read<uint16_t>(offset + classIndex * 2));
+        return read<float>(offset + classIndex * 4);
+    }
+
+    size_t probabilityBytes() const { return header->numClasses * ((header->flags & kSessionFloat16) ? 2 : 4); }
+
+public:
+    SessionRecordView(const uint8_t* data, const SessionHeader* header) : data(data), header(header) {}
+
+    uint64_t timestampNs() const { return read<uint64_t>(0); }
+    uint32_t frameIndex() const { return read<uint32_t>(8); }
+    uint32_t trackId() const { return read<uint32_t>(12); }
+    SessionRect rect() const { return read<SessionRect>(16); }
+    float raw(size_t classIndex) const { return probability(kSessionRecordFixedBytes, classIndex); }
+    float smoothed(size_t classIndex) const { return probability(kSessionRecordFixedBytes + probabilityBytes(), classIndex); }
+
+    // Decode all classes into `out` (numClasses floats).
+    void copyRaw(std::span<float> out) const {
+        for (size_t c = 0; c < std::min<size_t>(out.size(), header->numClasses); ++c)
+            out[c] = raw(c);
+    }
+    void copySmoothed(std::span<float> out) const {
+        for (size_t c = 0; c < std::min<size_t>(out.size(), header->numClasses); ++c)
+            out[c] = smoothed(c);
+    }
+};
+
+// Read-only memory mapping of a session file; records are decoded in place, so replay runs at
+// page-cache / memory bandwidth with no per-record I/O or allocation.
+class SessionReader {
+private:
+    const uint8_t* mapped = nullptr;
+    size_t mappedBytes = 0;
+    const SessionHeader* header = nullptr;
+    size_t records = 0;
+
+public:
+    explicit SessionReader(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st {};
+        if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(SessionHeader)) {
+            void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                mapped = static_cast<const uint8_t*>(p);
+                mappedBytes = static_cast<size_t>(st.st_size);
+                ::madvise(p, mappedBytes, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+        if (mapped == nullptr)
+            return;
+        header = reinterpret_cast<const SessionHeader*>(mapped);
+        const bool halfs = header->flags & kSessionFloat16;
+        if (header->magic != kSessionMagic || header->version != kSessionVersion || header->numClasses == 0
+            || header->recordSize != sessionRecordSize(header->numClasses, halfs)) {
+            header = nullptr;
+            return;
+        }
+        records = (mappedBytes - sizeof(SessionHeader)) / header->recordSize;
+    }
+
+    ~SessionReader() {
+        if (mapped != nullptr)
+            ::munmap(const_cast<uint8_t*>(mapped), mappedBytes);
+    }
+
+    SessionReader(const SessionReader&) = delete;
+    SessionReader& operator=(const SessionReader&) = delete;
+
+    // False when the file is missing, not a session, or from another format version.
+    bool isValid() const { return header != nullptr; }
+    const SessionHeader& sessionHeader() const { return *header; }
+    size_t numClasses() const { return header->numClasses; }
+    size_t size() const { return records; }
+    size_t bytes() const { return mappedBytes; }
+
+    SessionRecordView operator[](size_t index) const {
+        return { mapped + sizeof(SessionHeader) + index * header->recordSize, header };
+    }
+};
@@ -0,0 +1,151 @@
+//
+//  SmootherPool.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include "SmoothingPipeline.h"
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Axis-aligned face box in any consistent unit (pixels on desktop, normalized on iOS).
+struct FaceBox {
+    float x = 0, y = 0, width = 0, height = 0;
+
+    float area() const { return width * height; }
+};
+
+inline float intersectionOverUnion(const FaceBox& a, const FaceBox& b) {
+    const float ix = std::max(0.0f, std::min(a.x + a.width, b.x + b.width) - std::max(a.x, b.x));
+    const float iy = std::max(0.0f, std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y));
+    const float inter = ix * iy;
+    const float uni = a.area() + b.area() - inter;
+    return uni > 0 ? inter / uni : 0.0f;
+}
+
+// Fixed pool of per-face smoothing pipelines keyed by a lightweight IoU track ID.
+// Each frame's detections are matched to live tracks by greedy highest-IoU pairing, so a
+// face keeps its smoothing state when detection order changes. Unmatched detections start
+// a new track in a free slot; tracks unseen for more than maxMissedFrames are released and
+// their slot is recycled. All storage is allocated up front: update() never allocates.
+class SmootherPool {
+public:
+    static constexpr int kNoSlot = -1;
+
+private:
+    struct Track {
+        SmoothingPipeline smoothing;
+        FaceBox box;
+        uint32_t id = 0;
+        uint64_t lastSeen = 0;
+        bool active = false;
+
+        Track(size_t numClasses, size_t neutralIndex, const SmoothingSettings& settings)
+            : smoothing(numClasses, neutralIndex, settings) {}
+    };
+
+    struct Candidate {
+        float iou;
+        uint32_t detection;
+        uint32_t slot;
+    };
+
+    std::vector<Track> tracks;
+    std::vector<Candidate> candidates;  // Scratch, capacity maxFaces^2.
+    std::vector<uint8_t> matched;       // Scratch, one flag per slot.
+    float minIou;
+    uint64_t maxMissedFrames;
+    uint64_t frameIndex = 0;
+    uint32_t nextId = 1;
+
+    int claimSlot() {
+        int stalest = kNoSlot;
+        for (size_t s = 0; s < tracks.size(); ++s) {
+            if (!tracks[s].active) return static_cast<int>(s);
+            if (!matched[s] && (stalest == kNoSlot || tracks[s].lastSeen < tracks[stalest].lastSeen))
+                stalest = static_cast<int>(s);
+        }
+        return stalest;
+    }
+
+public:
+    // Throws std::invalid_argument for class layouts SmoothingPipeline cannot smooth.
+    SmootherPool(size_t maxFaces, size_t numClasses, size_t neutralIndex,
+        const SmoothingSettings& settings = {}, float minIou = 0.3f, uint64_t maxMissedFrames = 5)
+        : matched(maxFaces, 0), minIou(minIou), maxMissedFrames(maxMissedFrames) {
+        tracks.reserve(maxFaces);
+        for (size_t s = 0; s < maxFaces; ++s)
+            tracks.emplace_back(numClasses, neutralIndex, settings);
+        candidates.reserve(maxFaces * maxFaces);
+    }
+
+    // Match this frame's detections to tracks. Writes the slot index for each box into
+    // `slotForBox` (kNoSlot when the pool is exhausted). Only the first capacity() boxes
+    // are considered.
+    void update(std::span<const FaceBox> boxes, std::span<int> slotForBox) {
+        frameIndex++;
+        const size_t n = std::min({ boxes.size(), slotForBox.size(), tracks.size() });
+        std::fill(slotForBox.begin(), slotForBox.end(), kNoSlot);
+        std::fill(matched.begin(), matched.end(), uint8_t{0});
+
+        candidates.clear();
+        for (size_t d = 0; d < n; ++d) {
+            for (size_t s = 0; s < tracks.size(); ++s) {
+                if (!tracks[s].active) continue;
+                const float iou = intersectionOverUnion(boxes[d], tracks[s].box);
+                if (iou >= minIou)
+                    candidates.push_back({ iou, static_cast<uint32_t>(d), static_cast<uint32_t>(s) });
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            if (a.iou != b.iou) return a.iou > b.iou;
+            return a.detection != b.detection ? a.detection < b.detection : a.slot < b.slot;
+        });
+        for (const auto& c : candidates) {
+            if (slotForBox[c.detection] != kNoSlot || matched[c.slot]) continue;
+            slotForBox[c.detection] = static_cast<int>(c.slot);
+            matched[c.slot] = 1;
+        }
+
+        for (size_t d = 0; d < n; ++d) {
+            if (slotForBox[d] == kNoSlot) {
+                const int slot = claimSlot();
+                if (slot == kNoSlot) continue;
+                Track& track = tracks[slot];
+                track.id = nextId++;
+                track.active = true;
+                track.smoothing.reset();
+                slotForBox[d] = slot;
+                matched[slot] = 1;
+            }
+            Track& track = tracks[slotForBox[d]];
+            track.box = boxes[d];
+            track.lastSeen = frameIndex;
+        }
+
+        for (auto& track : tracks) {
+            if (track.active && frameIndex - track.lastSeen > maxMissedFrames)
+                track.active = false;
+        }
+    }
+
+    SmoothingPipeline& smoother(int slot) { return tracks[slot].smoothing; }
+    const SmoothingPipeline& smoother(int slot) const { return tracks[slot].smoothing; }
+    uint32_t trackId(int slot) const { return tracks[slot].id; }
+
+    size_t capacity() const { return tracks.size(); }
+    size_t activeCount() const {
+        return static_cast<size_t>(std::count_if(tracks.begin(), tracks.end(), [](const Track& t) { return t.active; }));
+    }
+
+    void reset() {
+        for (auto& track : tracks) {
+            track.active = false;
+            track.smoothing.reset();
+        }
+    }
+};
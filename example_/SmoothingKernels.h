@@ -0,0 +1,175 @@
+//
+//  SmoothingKernels.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <cstddef>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define FER_SMOOTHING_X86 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define FER_SMOOTHING_NEON 1
+#endif
+
+// Fused neutral-boost + re-normalize + EMA kernels over a padded batch layout.
+//
+// Layout: `faces` rows of kSmoothingLanes floats each (7 classes + 1 zero pad lane), so one
+// face fills exactly one AVX register or two SSE/NEON registers. The pad lane must stay 0 in
+// `probs` so it does not contribute to the normalizing sum.
+//
+// Per row the kernel computes, in one pass:
+//   probs[neutral] *= boostFactor
+//   probs /= sum(probs)                     (skipped when the sum is not positive)
+//   ema = alpha * probs + (1 - alpha) * ema
+// `alphas` holds one alpha per row; pass 1.0f for a row whose EMA has not been seeded yet
+// (its ema row must then be finite, e.g. zero) and the row is initialised to the adjusted frame.
+//
+// The scalar path reproduces EmotionProbabilityAdjuster::adjust followed by applyEma exactly.
+// The vector paths sum with a tree reduction rather than left to right, so results may differ
+// by a few ulp; every output stays within kSmoothingKernelTolerance of the scalar path.
+constexpr size_t kSmoothingLanes = 8;
+constexpr float kSmoothingKernelTolerance = 1e-6f;
+
+// Reference implementation; also the fallback when no vector ISA is available.
+inline void fusedSmoothScalar(float* probs, float* ema, const float* alphas, size_t faces,
+    size_t neutralIndex, float boostFactor) {
+    for (size_t f = 0; f < faces; ++f) {
+        float* p = probs + f * kSmoothingLanes;
+        float* e = ema + f * kSmoothingLanes;
+        p[neutralIndex] *= boostFactor;
+        float sum = 0.0f;
+        for (size_t i = 0; i < kSmoothingLanes; ++i)
+            sum += p[i];
+        if (sum > 0) {
+            for (size_t i = 0; i < kSmoothingLanes; ++i)
+                p[i] /= sum;
+        }
+        const float alpha = alphas[f];
+        for (size_t i = 0; i < kSmoothingLanes; ++i)
+            e[i] = alpha * p[i] + (1.0f - alpha) * e[i];
+    }
+}
+
+#if defined(FER_SMOOTHING_X86)
+namespace smoothing_detail {
+    inline float horizontalSum(__m128 v) {
+        __m128 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        __m128 total = _mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(total);
+    }
+
+    inline __m128 boostMask(size_t neutralIndex, size_t half, float boostFactor) {
+        alignas(16) float lanes[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        if (neutralIndex / 4 == half) lanes[neutralIndex % 4] = boostFactor;
+        return _mm_load_ps(lanes);
+    }
+}
+#endif
+
+#if defined(__AVX2__)
+inline void fusedSmoothAvx2(float* probs, float* ema, const float* alphas, size_t faces,
+    size_t neutralIndex, float boostFactor) {
+    const __m256 boost = _mm256_set_m128(smoothing_detail::boostMask(neutralIndex, 1, boostFactor),
+                                         smoothing_detail::boostMask(neutralIndex, 0, boostFactor));
+    const __m256 one = _mm256_set1_ps(1.0f);
+    for (size_t f = 0; f < faces; ++f) {
+        float* p = probs + f * kSmoothingLanes;
+        float* e = ema + f * kSmoothingLanes;
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(p), boost);
+        const float sum = smoothing_detail::horizontalSum(
+            _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+        if (sum > 0)
+            v = _mm256_div_ps(v, _mm256_set1_ps(sum));
+        _mm256_storeu_ps(p, v);
+        const __m256 alpha = _mm256_set1_ps(alphas[f]);
+        const __m256 keep = _mm256_sub_ps(one, alpha);
+        _mm256_storeu_ps(e, _mm256_add_ps(_mm256_mul_ps(alpha, v), _mm256_mul_ps(keep, _mm256_loadu_ps(e))));
+    }
+}
+#endif
+
+#if defined(FER_SMOOTHING_X86)
+inline void fusedSmoothSse(float* probs, float* ema, const float* alphas, size_t faces,
+    size_t neutralIndex, float boostFactor) {
+    const __m128 boostLo = smoothing_detail::boostMask(neutralIndex, 0, boostFactor);
+    const __m128 boostHi = smoothing_detail::boostMask(neutralIndex, 1, boostFactor);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (size_t f = 0; f < faces; ++f) {
+        float* p = probs + f * kSmoothingLanes;
+        float* e = ema + f * kSmoothingLanes;
+        __m128 lo = _mm_mul_ps(_mm_loadu_ps(p), boostLo);
+        __m128 hi = _mm_mul_ps(_mm_loadu_ps(p + 4), boostHi);
+        const float sum = smoothing_detail::horizontalSum(_mm_add_ps(lo, hi));
+        if (sum > 0) {
+            const __m128 s = _mm_set1_ps(sum);
+            lo = _mm_div_ps(lo, s);
+            hi = _mm_div_ps(hi, s);
+        }
+        _mm_storeu_ps(p, lo);
+        _mm_storeu_ps(p + 4, hi);
+        const __m128 alpha = _mm_set1_ps(alphas[f]);
+        const __m128 keep = _mm_sub_ps(one, alpha);
+        _mm_storeu_ps(e, _mm_add_ps(_mm_mul_ps(alpha, lo), _mm_mul_ps(keep, _mm_loadu_ps(e))));
+        _mm_storeu_ps(e + 4, _mm_add_ps(_mm_mul_ps(alpha, hi), _mm_mul_ps(keep, _mm_loadu_ps(e + 4))));
+    }
+}
+#endif
+
+#if defined(FER_SMOOTHING_NEON)
+inline void fusedSmoothNeon(float* probs, float* ema, const float* alphas, size_t faces,
+    size_t neutralIndex, float boostFactor) {
+    float lanes[kSmoothingLanes] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+    lanes[neutralIndex] = boostFactor;
+    const float32x4_t boostLo = vld1q_f32(lanes);
+    const float32x4_t boostHi = vld1q_f32(lanes + 4);
+    for (size_t f = 0; f < faces; ++f) {
+        float* p = probs + f * kSmoothingLanes;
+        float* e = ema + f * kSmoothingLanes;
+        float32x4_t lo = vmulq_f32(vld1q_f32(p), boostLo);
+        float32x4_t hi = vmulq_f32(vld1q_f32(p + 4), boostHi);
+        const float sum = vaddvq_f32(vaddq_f32(lo, hi));
+        if (sum > 0) {
+            const float32x4_t s = vdupq_n_f32(sum);
+            lo = vdivq_f32(lo, s);
+            hi = vdivq_f32(hi, s);
+        }
+        vst1q_f32(p, lo);
+        vst1q_f32(p + 4, hi);
+        const float32x4_t alpha = vdupq_n_f32(alphas[f]);
+        const float32x4_t keep = vdupq_n_f32(1.0f - alphas[f]);
+        vst1q_f32(e, vaddq_f32(vmulq_f32(alpha, lo), vmulq_f32(keep, vld1q_f32(e))));
+        vst1q_f32(e + 4, vaddq_f32(vmulq_f32(alpha, hi), vmulq_f32(keep, vld1q_f32(e + 4))));
+    }
+}
+#endif
+
+// Best kernel available for the target the translation unit is compiled for.
+inline void fusedSmooth(float* probs, float* ema, const float* alphas, size_t faces,
+    size_t neutralIndex, float boostFactor) {
+#if defined(__AVX2__)
+    fusedSmoothAvx2(probs, ema, alphas, faces, neutralIndex, boostFactor);
+#elif defined(FER_SMOOTHING_X86)
+    fusedSmoothSse(probs, ema, alphas, faces, neutralIndex, boostFactor);
+#elif defined(FER_SMOOTHING_NEON)
+    fusedSmoothNeon(probs, ema, alphas, faces, neutralIndex, boostFactor);
+#else
+    fusedSmoothScalar(probs, ema, alphas, faces, neutralIndex, boostFactor);
+#endif
+}
+
+// Name of the kernel fusedSmooth() dispatches to, for benchmark and log output.
+constexpr const char* fusedSmoothKernelName() {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(FER_SMOOTHING_X86)
+    return "sse";
+#elif defined(FER_SMOOTHING_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
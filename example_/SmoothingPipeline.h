@@ -0,0 +1,105 @@
+//
+//  SmoothingPipeline.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include "SmoothingKernels.h"
+#include "ProbabilityHistory.h"
+#include "RunningMedian.h"
+#include <algorithm>
+#include <array>
+#include <span>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+// Smoothing parameters; field names and defaults mirror the iOS InferenceSettings.
+struct SmoothingSettings {
+    float neutralBoost = 2.0f;
+    float emaAlpha = 0.1f;
+    size_t ringBufferSize = 60;
+    size_t framesForAverage = 30;
+    // Desktop only: compact history for long timelines (see ProbabilityHistory.h).
+    HistoryPrecision historyPrecision = HistoryPrecision::float32;
+    size_t historyLevels = 0;
+
+    // Median window, capped by the history like TemporalSmoother.medianWindow(for:).
+    size_t medianWindow() const { return std::max<size_t>(1, std::min(framesForAverage, ringBufferSize)); }
+};
+
+// One face's whole smoothing chain: neutral boost + re-normalize, EMA, history ring and
+// running median. push() runs every stage in a single pass over fixed buffers it owns,
+// so there are no intermediate vectors and nothing allocates after construction.
+// Behaves like the iOS TemporalSmoother.smooth(_:) for the same settings.
+class SmoothingPipeline {
+private:
+    size_t classes;
+    size_t neutralIndex;
+    SmoothingSettings settings;
+    alignas(32) std::array<float, kSmoothingLanes> frame{};  // Adjusted input, zero pad lane.
+    alignas(32) std::array<float, kSmoothingLanes> ema{};    // EMA state.
+    std::array<float, kSmoothingLanes> medians{};            // Output of the last push().
+    std::array<float, kSmoothingLanes> stored{};             // EMA frame as the compact history holds it.
+    bool seeded = false;
+    ProbabilityHistory historyRing;
+    RunningMedian median;
+
+    static size_t checkedClasses(size_t numClasses, size_t neutralIndex) {
+        if (!supports(numClasses, neutralIndex))
+            throw std::invalid_argument("SmoothingPipeline needs 1-" + std::to_string(kSmoothingLanes)
+                + " classes and a neutral index below the class count");
+        return numClasses;
+    }
+
+public:
+    // True when push() can smooth frames of numClasses probabilities: they must fit the
+    // kernel lanes (the FER models use 7) and neutralIndex must name one of the classes.
+    static bool supports(size_t numClasses, size_t neutralIndex) {
+        return numClasses > 0 && numClasses <= kSmoothingLanes && neutralIndex < numClasses;
+    }
+
+    // Throws std::invalid_argument unless supports(numClasses, neutralIndex).
+    SmoothingPipeline(size_t numClasses, size_t neutralIndex, const SmoothingSettings& settings = {})
+        : classes(checkedClasses(numClasses, neutralIndex)), neutralIndex(neutralIndex), settings(settings),
+          historyRing(classes, settings.ringBufferSize, settings.historyPrecision, settings.historyLevels),
+          median(classes, settings.medianWindow()) {}
+
+    // Feed one raw frame of numClasses probabilities; returns the smoothed (median) frame.
+    // The pointer stays valid until the next push() or reset().
+    const float* push(const float* probs) {
+        std::copy_n(probs, classes, frame.begin());
+        const float alpha = seeded ? settings.emaAlpha : 1.0f;
+        fusedSmooth(frame.data(), ema.data(), &alpha, 1, neutralIndex, settings.neutralBoost);
+        seeded = true;
+
+        const std::span<const float> smoothed(ema.data(), classes);
+        historyRing.push(smoothed);
+        if (settings.historyPrecision == HistoryPrecision::float32) {
+            median.push(smoothed);
+        } else {
+            // The median reads the quantized values, so it matches a median over the stored
+            // history; quantization is monotonic, so its error keeps the history's bound.
+            historyRing.latestFrame(std::span<float>(stored.data(), classes));
+            median.push(std::span<const float>(stored.data(), classes));
+        }
+        median.median(std::span<float>(medians.data(), classes));
+        return medians.data();
+    }
+
+    // Smoothed output of the last push() (zeros before the first one).
+    std::span<const float> output() const { return { medians.data(), classes }; }
+    std::span<const float> emaState() const { return { ema.data(), classes }; }
+    const ProbabilityHistory& history() const { return historyRing; }
+    const SmoothingSettings& currentSettings() const { return settings; }
+    size_t numClasses() const { return classes; }
+
+    void reset() {
+        ema.fill(0.0f);
+        medians.fill(0.0f);
+        seeded = false;
+        historyRing.reset();
+        median.reset();
+    }
+};
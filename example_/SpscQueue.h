@@ -0,0 +1,136 @@
+//
+//  SpscQueue.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+// Bounded lock-free single-producer / single-consumer queue for handing frames between
+// pipeline stages. Capacity is a power of two; head and tail live on separate cache lines.
+//
+// Drop policy is latest-frame-wins at both ends, so a slow stage never builds up latency:
+// tryPush() on a full queue evicts the oldest queued item to make room for the new one, and
+// popLatest() skips everything but the newest queued item. Both count what they discard in
+// dropped().
+// Evicting means the producer also takes items off the tail, so both ends claim items with a
+// CAS on tail, and each slot carries a sequence number (as in Vyukov's bounded queue) that
+// tells the producer when the consumer has finished moving out of a slot it is about to reuse.
+template<typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+    static constexpr size_t mask = Capacity - 1;
+
+    // `sequence` is the push index the slot is free for; index + 1 once that item is written.
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    std::array<Slot, Capacity> slots;
+    alignas(64) std::atomic<size_t> head{0};       // Next index to write; written by the producer only.
+    alignas(64) std::atomic<size_t> tail{0};       // Oldest unclaimed index; advanced by either end.
+    alignas(64) std::atomic<uint32_t> signal{0};   // Bumped on every push and on close() to wake the consumer.
+    std::atomic<bool> closed{false};
+    std::atomic<uint64_t> droppedCount{0};
+
+    // Hand claimed indices [from, to) back to the producer.
+    void release(size_t from, size_t to) {
+        for (size_t i = from; i < to; ++i)
+            slots[i & mask].sequence.store(i + Capacity, std::memory_order_release);
+    }
+
+public:
+    SpscQueue() {
+        for (size_t i = 0; i < Capacity; ++i)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Producer side. Never blocks on a slow consumer: a full queue loses its oldest item.
+    // Returns false (leaving `value` untouched) only once the queue is closed.
+    bool tryPush(T&& value) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (closed.load(std::memory_order_relaxed)) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        size_t t = tail.load(std::memory_order_acquire);
+        if (h - t == Capacity && tail.compare_exchange_strong(t, t + 1, std::memory_order_acq_rel)) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            release(t, t + 1);
+        }
+        // The slot may still be moved out of by a consumer that claimed it just before the
+        // eviction; that is a single move, so waiting for it is brief.
+        Slot& slot = slots[h & mask];
+        while (slot.sequence.load(std::memory_order_acquire) != h)
+            std::this_thread::yield();
+        slot.value = std::move(value);
+        slot.sequence.store(h + 1, std::memory_order_release);
+        head.store(h + 1, std::memory_order_release);
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_one();
+        return true;
+    }
+
+    // Consumer side. Pops the oldest item without blocking.
+    bool tryPop(T& out) {
+        size_t t = tail.load(std::memory_order_acquire);
+        do {
+            if (t == head.load(std::memory_order_acquire))
+                return false;
+        } while (!tail.compare_exchange_weak(t, t + 1, std::memory_order_acq_rel));
+        out = std::move(slots[t & mask].value);
+        release(t, t + 1);
+        return true;
+    }
+
+    // Consumer side. Blocks until an item is queued, then pops the newest one and discards
+    // the older ones. Returns false once the queue is closed and drained.
+    bool popLatest(T& out) {
+        size_t t, h;
+        for (;;) {
+            const uint32_t seen = signal.load(std::memory_order_acquire);
+            t = tail.load(std::memory_order_acquire);
+            h = head.load(std::memory_order_acquire);
+            if (h != t) {
+                // Fails only when the producer evicted the oldest item meanwhile; look again.
+                if (tail.compare_exchange_strong(t, h, std::memory_order_acq_rel))
+                    break;
+                continue;
+            }
+            if (closed.load(std::memory_order_acquire))
+                return false;
+            signal.wait(seen, std::memory_order_acquire);
+        }
+        droppedCount.fetch_add(h - t - 1, std::memory_order_relaxed);
+        out = std::move(slots[(h - 1) & mask].value);
+        release(t, h);
+        return true;
+    }
+
+    // Stop accepting items and wake a blocked consumer; popLatest() still drains what is queued.
+    void close() {
+        closed.store(true, std::memory_order_release);
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_all();
+    }
+
+    bool isClosed() const { return closed.load(std::memory_order_acquire); }
+    uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+    // Items queued right now; read from any thread, it is a snapshot that may already be stale.
+    size_t size() const {
+        const size_t t = tail.load(std::memory_order_acquire);
+        const size_t h = head.load(std::memory_order_acquire);
+        return std::min(h - t, Capacity);
+    }
+    static constexpr size_t capacity() { return Capacity; }
+};
@@ -0,0 +1,165 @@
+//
+//  StreamScheduler.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+struct StreamQueueStats {
+    uint64_t submitted = 0;
+    uint64_t replaced = 0;  // Pending items overwritten by a newer one before a worker took them.
+    uint64_t served = 0;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const StreamQueueStats& s) {
+    return os << s.served << "/" << s.submitted << " served, " << s.replaced << " replaced";
+}
+
+// Fair hand-off of per-stream work to a shared set of worker threads, for running one
+// pipeline stage over many camera / RTSP streams (see server.cpp).
+// Each stream has one pending slot with SpscQueue's latest-frame-wins policy: a newer item
+// replaces one no worker has taken yet, so a stream that produces faster than the stage
+// keeps up by losing its stale frames, memory stays bounded and producers never block.
+// Workers take streams in round-robin order from a rotating cursor, and a stream is held by
+// at most one worker until done(), so per-stream state (tracker, smoothers) needs no lock
+// and a busy stream gets one turn per round like every other stream.
+// One mutex guards everything: items are whole frames, so it is taken a few hundred times
+// a second at most.
+template<typename T>
+class StreamScheduler {
+private:
+    struct Stream {
+        std::optional<T> pending;
+        bool busy = false;
+        StreamQueueStats stats;
+    };
+
+    mutable std::mutex lock;
+    std::condition_variable ready;
+    std::vector<Stream> streams;
+    size_t cursor = 0;
+    bool closed = false;
+
+    bool isReady(size_t s) const { return streams[s].pending && !streams[s].busy; }
+
+    // First ready stream at or after `from` in round-robin order, or streams.size().
+    size_t nextReady(size_t from) const {
+        for (size_t k = 0; k < streams.size(); ++k) {
+            const size_t s = (from + k) % streams.size();
+            if (isReady(s))
+                return s;
+        }
+        return streams.size();
+    }
+
+    T take(size_t s) {
+        Stream& stream = streams[s];
+        T item = std::move(*stream.pending);
+        stream.pending.reset();
+        stream.busy = true;
+        stream.stats.served++;
+        return item;
+    }
+
+public:
+    explicit StreamScheduler(size_t streamCount) : streams(streamCount) {}
+
+    StreamScheduler(const StreamScheduler&) = delete;
+    StreamScheduler& operator=(const StreamScheduler&) = delete;
+
+    // Producer side; never blocks. False (dropping the item) after close().
+    bool submit(size_t stream, T&& item) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (closed)
+                return false;
+            Stream& s = streams[stream];
+            s.stats.submitted++;
+            if (s.pending)
+                s.stats.replaced++;
+            s.pending = std::move(item);
+        }
+        ready.notify_one();
+        return true;
+    }
+
+    // Worker side: blocks until a stream has a pending item no other worker holds, then holds
+    // that stream until done(stream). False once closed; items still pending are dropped.
+    bool acquire(size_t& stream, T& item) {
+        std::unique_lock<std::mutex> guard(lock);
+        ready.wait(guard, [&] { return closed || nextReady(cursor) < streams.size(); });
+        if (closed)
+            return false;
+        stream = nextReady(cursor);
+        cursor = (stream + 1) % streams.size();
+        item = take(stream);
+        return true;
+    }
+
+    // Batching worker side: takes the pending items of up to every stream, one per stream, in
+    // round-robin order while their total cost(item) fits `budget` (the first always fits),
+    // and holds every taken stream until done(). The cursor resumes at the first stream left
+    // out, so a stream with many faces cannot keep the others out of consecutive batches.
+    template<typename Cost>
+    bool acquireBatch(std::vector<std::pair<size_t, T>>& out, size_t budget, Cost&& cost) {
+        out.clear();
+        std::unique_lock<std::mutex> guard(lock);
+        ready.wait(guard, [&] { return closed || nextReady(cursor) < streams.size(); });
+        if (closed)
+            return false;
+        size_t spent = 0;
+        size_t resume = streams.size();
+        for (size_t k = 0; k < streams.size(); ++k) {
+            const size_t s = (cursor + k) % streams.size();
+            if (!isReady(s))
+                continue;
+            const size_t c = cost(*streams[s].pending);
+            if (!out.empty() && spent + c > budget) {
+                if (resume == streams.size())
+                    resume = s;
+                continue;
+            }
+            spent += c;
+            out.emplace_back(s, take(s));
+        }
+        cursor = resume < streams.size() ? resume : (out.back().first + 1) % streams.size();
+        return true;
+    }
+
+    // Release a stream taken by acquire() or acquireBatch().
+    void done(size_t stream) {
+        bool pending;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            streams[stream].busy = false;
+            pending = streams[stream].pending.has_value();
+        }
+        if (pending)
+            ready.notify_one();
+    }
+
+    // Wake every waiting worker; later acquires and submits fail.
+    void close() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+    size_t size() const { return streams.size(); }
+
+    StreamQueueStats stats(size_t stream) const {
+        std::lock_guard<std::mutex> guard(lock);
+        return streams[stream].stats;
+    }
+};
@@ -0,0 +1,247 @@
+//
+//  Trace.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+// Low-overhead scoped-timer tracing for the hot path.
+//
+//   FER_TRACE_THREAD("inference");     // once per thread, names its track
+//   { FER_TRACE_SCOPE("detectMultiScale"); ... }
+//
+// Each thread records into its own fixed ring (single writer, no locks, no allocation after
+// the thread's first event) and keeps running per-stage counters. writeChromeTrace() dumps
+// the retained events as Chrome trace JSON (chrome://tracing, Perfetto); summary() returns
+// the counters. Build with -DFER_TRACING=1 to compile it in; otherwise both macros expand to
+// nothing and tracing costs nothing.
+// Event names must be string literals (only the pointer is stored). Dump once the traced
+// threads are idle or joined; events being written during a dump may be skipped.
+
+#ifndef FER_TRACING
+#define FER_TRACING 0
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+constexpr size_t kTraceRingSize = 4096;   // Events retained per thread (power of two).
+constexpr size_t kTraceMaxStages = 16;    // Distinct event names counted per thread.
+
+struct TraceEvent {
+    const char* name = nullptr;
+    uint64_t startNs = 0;
+    uint64_t durationNs = 0;
+};
+
+// Aggregated timings for one event name across every thread.
+struct TraceCounter {
+    const char* name = nullptr;
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+
+    double meanMs() const { return count ? totalNs / 1e6 / count : 0; }
+    double maxMs() const { return maxNs / 1e6; }
+};
+
+// One thread's events and counters; written only by its owning thread.
+class TraceRing {
+    static_assert((kTraceRingSize & (kTraceRingSize - 1)) == 0, "kTraceRingSize must be a power of two");
+
+private:
+    struct Stage {
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<uint64_t> count{ 0 };
+        std::atomic<uint64_t> totalNs{ 0 };
+        std::atomic<uint64_t> maxNs{ 0 };
+    };
+
+    std::array<TraceEvent, kTraceRingSize> events{};
+    std::array<Stage, kTraceMaxStages> stages{};
+    std::atomic<uint64_t> head{ 0 };
+
+    void count(const char* name, uint64_t durationNs) {
+        for (auto& stage : stages) {
+            const char* current = stage.name.load(std::memory_order_relaxed);
+            if (current == nullptr) {
+                stage.name.store(name, std::memory_order_release);
+                current = name;
+            }
+            if (current == name || std::strcmp(current, name) == 0) {
+                stage.count.store(stage.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                stage.totalNs.store(stage.totalNs.load(std::memory_order_relaxed) + durationNs, std::memory_order_relaxed);
+                if (durationNs > stage.maxNs.load(std::memory_order_relaxed))
+                    stage.maxNs.store(durationNs, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+public:
+    const uint32_t threadId;
+    std::atomic<const char*> threadName{ nullptr };
+
+    explicit TraceRing(uint32_t threadId) : threadId(threadId) {}
+
+    void record(const char* name, uint64_t startNs, uint64_t durationNs) {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        events[h & (kTraceRingSize - 1)] = { name, startNs, durationNs };
+        head.store(h + 1, std::memory_order_release);
+        count(name, durationNs);
+    }
+
+    // Retained events, oldest first.
+    void collect(std::vector<TraceEvent>& out) const {
+        const uint64_t h = head.load(std::memory_order_acquire);
+        const uint64_t first = h > kTraceRingSize ? h - kTraceRingSize : 0;
+        for (uint64_t i = first; i < h; ++i)
+            out.push_back(events[i & (kTraceRingSize - 1)]);
+    }
+
+    void addCounters(std::vector<TraceCounter>& totals) const {
+        for (const auto& stage : stages) {
+            const char* name = stage.name.load(std::memory_order_acquire);
+            if (name == nullptr)
+                break;
+            TraceCounter* total = nullptr;
+            for (auto& t : totals) {
+                if (std::strcmp(t.name, name) == 0)
+                    total = &t;
+            }
+            if (total == nullptr)
+                total = &totals.emplace_back(TraceCounter{ name });
+            total->count += stage.count.load(std::memory_order_relaxed);
+            total->totalNs += stage.totalNs.load(std::memory_order_relaxed);
+            total->maxNs = std::max(total->maxNs, stage.maxNs.load(std::memory_order_relaxed));
+        }
+    }
+};
+
+// Owns every thread's ring. The mutex is only taken when a thread records its first event
+// and when dumping.
+class TraceRegistry {
+private:
+    mutable std::mutex lock;
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    TraceRegistry() = default;
+
+    static void writeJsonString(std::ostream& os, const char* text) {
+        os << '"';
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\')
+                os << '\\';
+            os << *c;
+        }
+        os << '"';
+    }
+
+public:
+    static TraceRegistry& instance() {
+        static TraceRegistry registry;
+        return registry;
+    }
+
+    TraceRing& ring() {
+        thread_local TraceRing* local = nullptr;
+        if (local == nullptr) {
+            std::lock_guard<std::mutex> guard(lock);
+            rings.push_back(std::make_unique<TraceRing>(static_cast<uint32_t>(rings.size() + 1)));
+            local = rings.back().get();
+        }
+        return *local;
+    }
+
+    uint64_t nowNs() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    void nameThisThread(const char* name) { ring().threadName.store(name, std::memory_order_release); }
+
+    // Per-name counters over the whole run, summed across threads.
+    std::vector<TraceCounter> summary() const {
+        std::vector<TraceCounter> totals;
+        std::lock_guard<std::mutex> guard(lock);
+        for (const auto& r : rings)
+            r->addCounters(totals);
+        return totals;
+    }
+
+    // Chrome trace event format: one complete ("X") event per scope, one track per thread.
+    void writeChromeTrace(std::ostream& os) const {
+        std::lock_guard<std::mutex> guard(lock);
+        std::vector<TraceEvent> events;
+        events.reserve(kTraceRingSize);
+        bool first = true;
+        const auto separator = [&] { os << (first ? "\n" : ",\n"); first = false; };
+
+        os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (const auto& r : rings) {
+            if (const char* name = r->threadName.load(std::memory_order_acquire)) {
+                separator();
+                os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << r->threadId << ",\"args\":{\"name\":";
+                writeJsonString(os, name);
+                os << "}}";
+            }
+            events.clear();
+            r->collect(events);
+            for (const auto& e : events) {
+                if (e.name == nullptr)
+                    continue;
+                separator();
+                os << "{\"name\":";
+                writeJsonString(os, e.name);
+                os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << r->threadId
+                   << ",\"ts\":" << e.startNs / 1000.0 << ",\"dur\":" << e.durationNs / 1000.0 << "}";
+            }
+        }
+        os << "\n]}\n";
+    }
+
+    bool writeChromeTrace(const std::string& path) const {
+        std::ofstream file(path);
+        if (!file)
+            return false;
+        writeChromeTrace(file);
+        return static_cast<bool>(file);
+    }
+};
+
+// Records the enclosing scope as one event on the current thread's ring.
+class ScopedTrace {
+private:
+    const char* name;
+    TraceRing& ring;
+    uint64_t startNs;
+
+public:
+    explicit ScopedTrace(const char* name)
+        : name(name), ring(TraceRegistry::instance().ring()), startNs(TraceRegistry::instance().nowNs()) {}
+    ~ScopedTrace() { ring.record(name, startNs, TraceRegistry::instance().nowNs() - startNs); }
+
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+};
+
+#define FER_TRACE_CONCAT_INNER(a, b) a##b
+#define FER_TRACE_CONCAT(a, b) FER_TRACE_CONCAT_INNER(a, b)
+
+#if FER_TRACING
+#define FER_TRACE_SCOPE(name) ScopedTrace FER_TRACE_CONCAT(ferTraceScope, __LINE__)(name)
+#define FER_TRACE_THREAD(name) TraceRegistry::instance().nameThisThread(name)
+#else
+#define FER_TRACE_SCOPE(name) ((void)0)
+#define FER_TRACE_THREAD(name) ((void)0)
+#endif
@@ -0,0 +1,49 @@
+//
+//  TripleBuffer.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Wait-free single-writer / single-reader mailbox that always holds the newest value.
+// The writer fills writeBuffer() and publish()es it; the reader calls update() and, when it
+// returns true, reads readBuffer(). Neither side ever waits for the other: three slots are
+// rotated through one atomic exchange, and values published between two reads are coalesced.
+// The slot writeBuffer() hands back holds an older value, so the writer overwrites it fully.
+template<typename T>
+class TripleBuffer {
+private:
+    static constexpr uint8_t indexMask = 0x3;
+    static constexpr uint8_t dirtyBit = 0x4;
+
+    std::array<T, 3> slots{};
+    alignas(64) std::atomic<uint8_t> middle{ 1 };  // Slot being handed over, plus dirtyBit.
+    alignas(64) uint8_t back = 0;                   // Owned by the writer.
+    alignas(64) uint8_t front = 2;                  // Owned by the reader.
+
+public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(const T& initial) : slots{ initial, initial, initial } {}
+
+    // Writer side.
+    T& writeBuffer() { return slots[back]; }
+
+    void publish() {
+        back = middle.exchange(static_cast<uint8_t>(back | dirtyBit), std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Reader side. Takes the newest published value; false when nothing new arrived.
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & dirtyBit) == 0)
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T& readBuffer() const { return slots[front]; }
+    T& readBuffer() { return slots[front]; }
+};
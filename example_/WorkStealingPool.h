@@ -0,0 +1,118 @@
+//
+//  WorkStealingPool.h
+//  FacialExpressionDetection
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Parallel for-loop over [0, count) with range stealing, for offline jobs whose items vary a
+// lot in cost (e.g. one sweep configuration per item, where history length sets the cost).
+// Every worker starts with a contiguous block of indices and takes them from the front; a
+// worker that runs dry steals the back half of the fullest other block, so load balances
+// without a shared queue every item would contend on.
+// Each block is guarded by its own tiny lock: items are expected to take microseconds or
+// more, so the lock is never the bottleneck.
+class WorkStealingPool {
+private:
+    struct alignas(64) Block {
+        std::mutex lock;
+        size_t begin = 0;
+        size_t end = 0;
+
+        size_t remaining() {
+            std::lock_guard guard(lock);
+            return end - begin;
+        }
+    };
+
+    size_t workerCount;
+    std::atomic<uint64_t> stealCount{ 0 };
+
+    static bool takeFront(Block& block, size_t& index) {
+        std::lock_guard guard(block.lock);
+        if (block.begin == block.end)
+            return false;
+        index = block.begin++;
+        return true;
+    }
+
+    // Move the back half of the fullest other block into `own`; false when nothing is left.
+    bool steal(std::vector<std::unique_ptr<Block>>& blocks, size_t thief) {
+        while (true) {
+            size_t victim = thief, most = 0;
+            for (size_t w = 0; w < blocks.size(); ++w) {
+                if (w == thief)
+                    continue;
+                const size_t remaining = blocks[w]->remaining();
+                if (remaining > most) {
+                    most = remaining;
+                    victim = w;
+                }
+            }
+            if (most == 0)
+                return false;
+
+            size_t begin = 0, end = 0;
+            {
+                std::lock_guard guard(blocks[victim]->lock);
+                const size_t remaining = blocks[victim]->end - blocks[victim]->begin;
+                if (remaining == 0)
+                    continue;  // Drained since it was picked; look again.
+                end = blocks[victim]->end;
+                begin = end - (remaining + 1) / 2;
+                blocks[victim]->end = begin;
+            }
+            std::lock_guard guard(blocks[thief]->lock);
+            blocks[thief]->begin = begin;
+            blocks[thief]->end = end;
+            stealCount.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+public:
+    // threads == 0 uses every hardware thread.
+    explicit WorkStealingPool(size_t threads = 0)
+        : workerCount(threads ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+    size_t threads() const { return workerCount; }
+    // Successful steals across every run so far.
+    uint64_t steals() const { return stealCount.load(std::memory_order_relaxed); }
+
+    // Calls body(index, worker) once for every index in [0, count) and returns when all are
+    // done. `worker` is in [0, threads()), so callers can keep per-worker scratch state.
+    void parallelFor(size_t count, const std::function<void(size_t index, size_t worker)>& body) {
+        const size_t workers = std::min(workerCount, std::max<size_t>(count, 1));
+        std::vector<std::unique_ptr<Block>> blocks;
+        for (size_t w = 0; w < workers; ++w) {
+            blocks.push_back(std::make_unique<Block>());
+            blocks[w]->begin = count * w / workers;
+            blocks[w]->end = count * (w + 1) / workers;
+        }
+
+        auto run = [&](size_t worker) {
+            size_t index = 0;
+            do {
+                while (takeFront(*blocks[worker], index))
+                    body(index, worker);
+            } while (steal(blocks, worker));
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t w = 1; w < workers; ++w)
+            pool.emplace_back(run, w);
+        run(0);
+        for (std::thread& t : pool)
+            t.join();
+    }
+};
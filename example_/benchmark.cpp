@@ -0,0 +1,262 @@
+#include "SmootherPool.h"
+#include "FaceBatch.h"
+#include "FaceTracker.h"
+#include "LatencyStats.h"
+#include "FaceDetector.h"
+#include "CoreMLBridge.h"
+#include <iostream>
+#include <iomanip>
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <new>
+
+using namespace std;
+using namespace cv;
+
+// Headless benchmark: replays a video file or an image directory through
+// detection → batch packing → inference → smoothing (boost + EMA + median) with no GUI,
+// and reports per-stage latency percentiles, frames per second and allocations per frame.
+// Several detector backends (comma-separated) run one after another over the same source and
+// are compared in a final table.
+
+// Counts every operator new in the process; the frame loop reports the delta per frame.
+// Buffers OpenCV allocates with fastMalloc bypass operator new and are not counted.
+static atomic<size_t> allocationCount{ 0 };
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void* operator new(size_t size, align_val_t alignment) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    const size_t align = max(static_cast<size_t>(alignment), sizeof(void*));
+    void* p = nullptr;
+    if (posix_memalign(&p, align, size ? size : 1) == 0)
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, align_val_t) noexcept { free(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { free(p); }
+
+const vector<string> classes = { "fear", "angry", "sad", "neutral", "surprise", "disgust", "happy" };
+constexpr int64_t imageHeight = 128, imageWidth = 128, numClasses = 7;
+constexpr int imageChannels = 3;
+constexpr size_t neutralIndex = 3;
+constexpr int maxHistory = 60;
+constexpr size_t maxFaces = 16;
+// Samples each stage reserves when neither max-frames nor the source gives the run length
+// (about 36 minutes at 30 fps), and the most any run reserves up front.
+constexpr size_t defaultSamples = size_t(1) << 16;
+constexpr size_t maxReservedSamples = size_t(1) << 22;
+
+// Frames from a video file or, for a directory, its images in name order.
+class FrameSource {
+private:
+    VideoCapture capture;
+    vector<string> images;
+    size_t nextImage = 0;
+    bool fromImages = false;
+
+public:
+    explicit FrameSource(const string& path) {
+        namespace fs = std::filesystem;
+        if (fs::is_directory(path)) {
+            fromImages = true;
+            for (const auto& entry : fs::directory_iterator(path)) {
+                string ext = entry.path().extension().string();
+                transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+                if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp")
+                    images.push_back(entry.path().string());
+            }
+            sort(images.begin(), images.end());
+        } else {
+            capture.open(path);
+        }
+    }
+
+    bool isOpened() const { return fromImages ? !images.empty() : capture.isOpened(); }
+
+    // Frame count if known up front (0 otherwise).
+    size_t expectedFrames() const {
+        return fromImages ? images.size() : static_cast<size_t>(max(0.0, capture.get(CAP_PROP_FRAME_COUNT)));
+    }
+
+    bool read(Mat& frame) {
+        if (!fromImages)
+            return capture.read(frame) && !frame.empty();
+        while (nextImage < images.size()) {
+            frame = imread(images[nextImage++], IMREAD_COLOR);
+            if (!frame.empty())
+                return true;
+        }
+        return false;
+    }
+};
+
+void printReport(const vector<LatencyRecorder*>& stages, size_t frames, double seconds,
+    size_t allocations, size_t faces) {
+    cout << fixed << setprecision(3);
+    cout << "Frames: " << frames << " in " << seconds << " s, " << (seconds > 0 ? frames / seconds : 0) << " fps"
+         << " (smoothing kernel " << fusedSmoothKernelName() << ")\n";
+    cout << left << setw(14) << "stage" << right << setw(10) << "p50 ms" << setw(10) << "p95 ms"
+         << setw(10) << "p99 ms" << setw(10) << "mean ms" << "\n";
+    for (const LatencyRecorder* stage : stages) {
+        cout << left << setw(14) << stage->name() << right << setw(10) << stage->percentile(50)
+             << setw(10) << stage->percentile(95) << setw(10) << stage->percentile(99)
+             << setw(10) << stage->mean() << "\n";
+    }
+    cout << "Allocations/frame: " << (frames ? static_cast<double>(allocations) / frames : 0)
+         << " (operator new calls inside the frame loop)\n";
+    cout << "Faces/frame: " << (frames ? static_cast<double>(faces) / frames : 0) << "\n";
+}
+
+// One detector's pass over the source; the comparison table is printed from these.
+struct BenchmarkRun {
+    string detector;
+    size_t frames = 0;
+    double seconds = 0;
+    double detectP50 = 0, detectP95 = 0, detectMean = 0;
+    double facesPerFrame = 0;
+};
+
+BenchmarkRun runBenchmark(const string& sourcePath, size_t maxFrames, FaceDetector& detector, FERPredictor& predictor) {
+    FrameSource source(sourcePath);
+    DetectionSettings detection;
+    FaceTracker tracker(detection);
+    SmoothingSettings smoothingSettings;
+    smoothingSettings.ringBufferSize = maxHistory;
+    smoothingSettings.framesForAverage = maxHistory;
+    SmootherPool smoothers(maxFaces, numClasses, neutralIndex, smoothingSettings);
+    FaceBatch batch(maxFaces, imageHeight, imageWidth, imageChannels);
+    vector<FaceBox> faceBoxes(maxFaces);
+    vector<int> faceSlots(maxFaces);
+    vector<size_t> batchFaces;
+    batchFaces.reserve(maxFaces);
+    vector<float> batchProbabilities(maxFaces * numClasses);
+
+    // Reserve the sample storage for the whole run so recording does not show up as per-frame
+    // allocations: the shorter of max-frames and the source's frame count, whichever is known.
+    const size_t sourceFrames = source.expectedFrames();
+    const size_t runLength = sourceFrames ? min(maxFrames, sourceFrames) : maxFrames;
+    const size_t expected = min(runLength != SIZE_MAX ? runLength : defaultSamples, maxReservedSamples);
+    LatencyRecorder decodeStage("decode", expected), preprocessStage("preprocess", expected),
+        detectStage("detect", expected), packStage("pack", expected), inferenceStage("inference", expected),
+        smoothingStage("smoothing", expected), totalStage("total", expected);
+
+    Mat image, gray;
+    size_t frames = 0, faces = 0, allocations = 0;
+    const auto runStart = chrono::steady_clock::now();
+    while (frames < maxFrames) {
+        const size_t allocationsBefore = allocationCount.load(memory_order_relaxed);
+        const auto t0 = chrono::steady_clock::now();
+        if (!source.read(image))
+            break;
+        const auto t1 = chrono::steady_clock::now();
+        cvtColor(image, gray, COLOR_BGR2GRAY);
+        equalizeHist(gray, gray);
+        const auto t2 = chrono::steady_clock::now();
+        const vector<Rect>& features = tracker.update(gray, detector);
+        const auto t3 = chrono::steady_clock::now();
+        const size_t faceCount = min(features.size(), maxFaces);
+        for (size_t i = 0; i < faceCount; i++)
+            faceBoxes[i] = { static_cast<float>(features[i].x), static_cast<float>(features[i].y),
+                             static_cast<float>(features[i].width), static_cast<float>(features[i].height) };
+        smoothers.update(span<const FaceBox>(faceBoxes.data(), faceCount), span<int>(faceSlots.data(), faceCount));
+        batch.clear();
+        batchFaces.clear();
+        for (size_t i = 0; i < faceCount; i++) {
+            if (faceSlots[i] != SmootherPool::kNoSlot && batch.add(gray, features[i]))
+                batchFaces.push_back(i);
+        }
+        const auto t4 = chrono::steady_clock::now();
+        const bool predicted = !batch.empty() && predictBatch(predictor, batch, batchProbabilities, numClasses);
+        const auto t5 = chrono::steady_clock::now();
+        if (predicted) {
+            for (size_t b = 0; b < batchFaces.size(); b++)
+                smoothers.smoother(faceSlots[batchFaces[b]]).push(&batchProbabilities[b * numClasses]);
+        }
+        const auto t6 = chrono::steady_clock::now();
+        // Taken before recording: a source that outruns its reported length grows the sample
+        // storage, and that is the benchmark's bookkeeping, not the pipeline's.
+        allocations += allocationCount.load(memory_order_relaxed) - allocationsBefore;
+
+        decodeStage.record(t0, t1);
+        preprocessStage.record(t1, t2);
+        detectStage.record(t2, t3);
+        packStage.record(t3, t4);
+        inferenceStage.record(t4, t5);
+        smoothingStage.record(t5, t6);
+        totalStage.record(t0, t6);
+        faces += batchFaces.size();
+        frames++;
+    }
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - runStart).count();
+    cout << "== " << detector.name() << "\n";
+    printReport({ &decodeStage, &preprocessStage, &detectStage, &packStage, &inferenceStage, &smoothingStage, &totalStage },
+        frames, seconds, allocations, faces);
+    cout << "Detection: " << tracker.stats() << "\n";
+    return { detector.name(), frames, seconds, detectStage.percentile(50), detectStage.percentile(95), detectStage.mean(),
+        frames ? static_cast<double>(faces) / frames : 0 };
+}
+
+// Splits a comma-separated list of detector specs.
+vector<string> splitSpecs(const string& list) {
+    vector<string> specs;
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        const size_t end = min(list.find(',', begin), list.size());
+        if (end > begin)
+            specs.push_back(list.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return specs;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4 || argc > 5) {
+        cerr << "Usage: " << argv[0] << " <detector[,detector...]> <model.mlpackage> <video-file|image-dir> [max-frames]\n"
+             << "  detector: <cascade.xml> | tiled[N]:<cascade.xml> | dnn:<model>[:<config>]\n";
+        return EXIT_FAILURE;
+    }
+    // Every detector is loaded before the first run, so a bad spec fails fast.
+    vector<unique_ptr<FaceDetector>> detectors;
+    for (const string& spec : splitSpecs(argv[1])) {
+        detectors.push_back(makeFaceDetector(spec));
+        if (!detectors.back()) {
+            cerr << "Error loading detector from: " << spec << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (detectors.empty() || !FrameSource(argv[3]).isOpened()) {
+        cerr << "Cannot open video file or image directory: " << argv[3] << "\n";
+        return EXIT_FAILURE;
+    }
+    const size_t maxFrames = argc > 4 ? static_cast<size_t>(max(1, atoi(argv[4]))) : SIZE_MAX;
+
+    FERPredictor predictor(argv[2]);
+    vector<BenchmarkRun> runs;
+    for (const unique_ptr<FaceDetector>& detector : detectors)
+        runs.push_back(runBenchmark(argv[3], maxFrames, *detector, predictor));
+
+    if (runs.size() > 1) {
+        cout << "\n" << left << setw(24) << "detector" << right << setw(10) << "fps" << setw(12) << "detect p50"
+             << setw(12) << "detect p95" << setw(13) << "detect mean" << setw(13) << "faces/frame" << "\n";
+        for (const BenchmarkRun& run : runs) {
+            cout << left << setw(24) << run.detector << right << setw(10) << (run.seconds > 0 ? run.frames / run.seconds : 0)
+                 << setw(12) << run.detectP50 << setw(12) << run.detectP95 << setw(13) << run.detectMean
+                 << setw(13) << run.facesPerFrame << "\n";
+        }
+    }
+    return EXIT_SUCCESS;
+}
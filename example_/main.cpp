@@ -1,17 +1,36 @@
-#include "ProbabilityAdjustment.h"
+#include "SmootherPool.h"
+#include "FaceBatch.h"
+#include "SpscQueue.h"
+#include "FaceTracker.h"
+#include "ProbabilityGraph.h"
+#include "RenderScheduler.h"
+#include "InferenceRateController.h"
+#include "Trace.h"
+#include "SessionRecording.h"
+#include "FramePool.h"
+#include "FaceDetector.h"
+#include "PipelineTelemetry.h"
 #include "CoreMLBridge.h"
 #include <iostream>
+#include <iomanip>
 #include <opencv2/opencv.hpp>
-#include <deque>
 #include <random>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <thread>
 
 using namespace std;
 using namespace cv;
 
 const vector<string> classes = { "fear", "angry", "sad", "neutral", "surprise", "disgust", "happy" };
 constexpr int64_t imageHeight = 128, imageWidth = 128, numClasses = 7;
+constexpr int imageChannels = 3;  // 1 for a model variant that takes grayscale input directly.
+constexpr size_t neutralIndex = 3;
 constexpr int maxHistory = 60;
+constexpr size_t maxFaces = 16;
 const string window_name = "Face Detection";
 
 // Generate random colors for each class.
@@ -25,102 +44,106 @@ vector<Scalar> randomColors(size_t numColors) {
     return colors;
 }
 
-// Apply exponential moving average smoothing.
-vector<float> applyEma(const vector<float>& new_probs, vector<float>& ema_state, float alpha) {
-    if (ema_state.empty()) {
-        ema_state = new_probs;
-        return ema_state;
-    }
-    for (size_t i = 0; i < new_probs.size(); ++i) {
-        ema_state[i] = alpha * new_probs[i] + (1.0f - alpha) * ema_state[i];
-    }
-    return ema_state;
+// Draw detected face rectangles.
+void drawDetectedFeatures(Mat& image, const vector<Rect>& features) {
+    for (const auto& f : features)
+        rectangle(image, f, Scalar(0, 255, 0), 2);
 }
 
-// Compute median probability per class over the history buffer.
-vector<float> medianFromHistory(const deque<vector<float>>& history) {
-    if (history.empty()) return {};
-    size_t classesCount = history.front().size();
-    vector<float> medians(classesCount, 0.0f);
-    for (size_t c = 0; c < classesCount; ++c) {
-        vector<float> col;
-        col.reserve(history.size());
-        for (const auto& h : history) {
-            if (c < h.size()) col.push_back(h[c]);
-        }
-        if (!col.empty()) {
-            nth_element(col.begin(), col.begin() + col.size() / 2, col.end());
-            medians[c] = col[col.size() / 2];
-        }
-    }
-    return medians;
+// Label a face rectangle with its track ID.
+void drawTrackId(Mat& image, const Rect& face, uint32_t trackId) {
+    putText(image, "#" + to_string(trackId), Point(face.x, max(face.y - 5, 10)),
+        FONT_HERSHEY_PLAIN, 1, Scalar(0, 255, 0), 1, LINE_AA);
 }
 
-// Run inference on the given face using the provided Core ML predictor.
-vector<float> face2Int(Mat face, FERPredictor& predictor) {
-    vector<float> probabilities;
-    if (face.empty()) {
-        cerr << "Input face is empty.\n";
-        return probabilities;
-    }
-    if (face.rows != imageHeight || face.cols != imageWidth)
-        resize(face, face, Size(imageWidth, imageHeight));
-    
-    // Ensure 3 channels
-    if (face.channels() == 1) {
-        cvtColor(face, face, COLOR_GRAY2BGR);
+// Telemetry of the last few seconds in the top-left corner, one line per series.
+void drawTelemetryOverlay(Mat& image, const TelemetrySnapshot& telemetry) {
+    vector<string> lines;
+    const auto latencyLine = [&](const string& name, const LatencySummary& s) {
+        ostringstream line;
+        line << fixed << setprecision(1) << name << " p50 " << s.p50 << " p95 " << s.p95 << " p99 " << s.p99
+             << " ms";
+        lines.push_back(line.str());
+    };
+    latencyLine("glass-to-glass", telemetry.glassToGlass);
+    latencyLine("inference", telemetry.inference);
+    for (const StageSummary& stage : telemetry.stages) {
+        ostringstream line;
+        line << fixed << setprecision(1) << stage.name << " queue: " << stage.dropped << " dropped, depth "
+             << stage.meanDepth << " / " << stage.maxDepth;
+        lines.push_back(line.str());
     }
+    lines.push_back("last " + to_string(static_cast<int>(telemetry.windowSeconds)) + " s, t hides");
 
-    probabilities = predictor.predict(face);
-    return probabilities;
+    constexpr int lineHeight = 16;
+    rectangle(image, Rect(0, 0, 340, static_cast<int>(lines.size()) * lineHeight + 8), Scalar(0, 0, 0), FILLED);
+    for (size_t i = 0; i < lines.size(); i++) {
+        putText(image, lines[i], Point(6, static_cast<int>(i + 1) * lineHeight), FONT_HERSHEY_PLAIN, 1,
+            Scalar(255, 255, 255), 1, LINE_AA);
+    }
 }
 
-// Draw detected face rectangles.
-void drawDetectedFeatures(Mat& image, const vector<Rect>& features) {
-    for (const auto& f : features)
-        rectangle(image, f, Scalar(0, 255, 0), 2);
+FaceBox toFaceBox(const Rect& r) {
+    return { static_cast<float>(r.x), static_cast<float>(r.y), static_cast<float>(r.width), static_cast<float>(r.height) };
 }
 
-// Visualize probabilities as line graphs with history.
-void visualizeProbabilities(const vector<float>& probabilities, const vector<string>& classes,
-    Mat& graph, const deque<vector<float>>& history, int maxHistory, const vector<Scalar>& randomColorsVec) {
-    int width = 1600, height = 400, margin = 5;
-    int sectionWidth = width / classes.size();
-    float scaleX = static_cast<float>(sectionWidth - 2 * margin) / maxHistory;
-    float scaleY = static_cast<float>(height - 2 * margin);
-
-    if (graph.empty())
-        graph = Mat::zeros(height, width, CV_8UC3);
-    graph.setTo(Scalar(255, 255, 255));
-
-    for (int j = 0; j < classes.size(); j++) {
-        int sectionStart = j * sectionWidth;
-        line(graph, Point(sectionStart + margin, margin), Point(sectionStart + margin, height - margin),
-            Scalar(0, 0, 0), 1, LINE_AA);
-        line(graph, Point(sectionStart + margin, height - margin), Point(sectionStart + sectionWidth - margin, height - margin),
-            Scalar(0, 0, 0), 1, LINE_AA);
-        putText(graph, classes[j], Point(sectionStart + margin + 5, margin + 10),
-            FONT_HERSHEY_PLAIN, 1, Scalar(0, 0, 0), 1, LINE_AA);
-        for (size_t i = 0; i < history.size() - 1; i++) {
-            Point pt1(static_cast<int>(sectionStart + margin + i * scaleX),
-                static_cast<int>(height - margin - history[i][j] * scaleY));
-            Point pt2(static_cast<int>(sectionStart + margin + (i + 1) * scaleX),
-                static_cast<int>(height - margin - history[i + 1][j] * scaleY));
-            line(graph, pt1, pt2, randomColorsVec[j], 1, LINE_AA);
-        }
-    }
-    putText(graph, "DeltaTime", Point(width / 2 - 30, height - margin + 30),
-        FONT_HERSHEY_PLAIN, 0.3, Scalar(0, 0, 0), 1, LINE_AA);
-    putText(graph, "Probability", Point(width - 60, margin - 10),
-        FONT_HERSHEY_PLAIN, 0.3, Scalar(0, 0, 0), 1, LINE_AA);
-    imshow("Probabilities", graph);
-}
+// Frames handed between pipeline stages. Each stage owns a frame once it pops it.
+// `captured` is when the camera read returned, carried through so the render loop can
+// measure glass-to-glass latency.
+struct CapturedFrame {
+    Mat image;
+    chrono::steady_clock::time_point captured;
+};
+
+struct DetectedFrame {
+    Mat image;
+    Mat gray;
+    vector<Rect> features;
+    chrono::steady_clock::time_point captured;
+};
+
+struct RenderFrame {
+    Mat image;
+    vector<Rect> features;
+    vector<uint32_t> trackIds;  // 0 where the face has no smoothed output yet.
+    chrono::steady_clock::time_point captured;
+    chrono::steady_clock::time_point inferred;
+};
+
+// What the probability graph is drawn from: the primary face's smoothed history.
+struct GraphState {
+    uint32_t trackId = 0;
+    ProbabilityHistory history{ numClasses, maxHistory };
+};
+
+constexpr size_t stageQueueSize = 4;
+// Every queued or in-flight camera image (three queues plus one per stage, with slack) and
+// gray frame (detection to inference only: one queue plus two stages, with slack).
+constexpr size_t imagePoolSlots = 20;
+constexpr size_t grayPoolSlots = 8;
+constexpr double defaultGraphFps = 15;  // Same cap as the iOS AR graph.
+constexpr auto telemetryWindow = chrono::seconds(10);
+#if FER_TRACING
+const string traceOutputPath = "fer_trace.json";
+#endif
 
 // Capture video, perform face detection, inference, and visualization.
-void captureVideoAndProcess(const string& cascadePath, const string& modelPath) {
-    CascadeClassifier classifier;
-    if (!classifier.load(cascadePath)) {
-        cerr << "Error loading cascade from: " << cascadePath << "\n";
+// Capture, detection and inference each run on their own thread and rendering stays on the
+// main thread (HighGUI needs it), linked by SPSC queues that keep only the newest frame.
+// The stages overlap, so throughput is set by the slowest stage rather than their sum.
+// The probability graph is redrawn on its own thread at no more than graphFps, and only when
+// the inference stage published a new history.
+// With a recordingPath, every inferred face is appended to a session recording (see replay.cpp).
+// historyLevels > 0 keeps compact 16-bit histories with that many downsampled tiers, and the
+// graph then draws a long timeline whose older part comes from the coarser tiers.
+// The render loop keeps rolling telemetry (glass-to-glass latency, drops and depth of each
+// stage queue); 't' toggles it as an overlay and the last window is printed on exit.
+void captureVideoAndProcess(const string& detectorSpec, const string& modelPath, const DetectionSettings& detection,
+    double graphFps, const string& recordingPath, size_t historyLevels) {
+    // A cascade XML, tiled:<cascade.xml> or dnn:<model>[:<config>] (see makeFaceDetector).
+    const unique_ptr<FaceDetector> detector = makeFaceDetector(detectorSpec);
+    if (!detector) {
+        cerr << "Error loading detector from: " << detectorSpec << "\n";
         return;
     }
     VideoCapture capture(0);
@@ -132,53 +155,284 @@ void captureVideoAndProcess(const string& cascadePath, const string& modelPath)
     // Create Core ML Predictor.
     FERPredictor predictor(modelPath);
 
-    Mat image, gray;
-    vector<Rect> features;
-    deque<vector<float>> history;
-    vector<float> ema_state;
-    const float ema_alpha = 0.1f;
-    Mat graph;
-    vector<Scalar> randomColorsVec = randomColors(classes.size());
-    namedWindow("Probabilities", WINDOW_NORMAL);
+    // Camera images and gray frames come from preallocated arenas, one per frame size so a
+    // gray frame does not tie up a BGR-sized slot; declared before the queues so they
+    // outlive every frame. Sized for the camera's frames (1080p if unknown).
+    const int frameWidth = static_cast<int>(capture.get(CAP_PROP_FRAME_WIDTH));
+    const int frameHeight = static_cast<int>(capture.get(CAP_PROP_FRAME_HEIGHT));
+    const size_t framePixels = frameWidth > 0 && frameHeight > 0 ? size_t(frameWidth) * frameHeight : 1920 * 1080;
+    FramePool imagePool(imagePoolSlots, framePixels * 3);
+    FramePool grayPool(grayPoolSlots, framePixels);
+
+    SpscQueue<CapturedFrame, stageQueueSize> capturedFrames;
+    SpscQueue<DetectedFrame, stageQueueSize> detectedFrames;
+    SpscQueue<RenderFrame, stageQueueSize> renderFrames;
+    atomic<bool> running{ true };
+
+    // Axes and labels are cached; each redraw only scrolls the plots and draws the new segments.
+    ProbabilityGraph probabilityGraph(classes, randomColors(classes.size()), maxHistory);
+    TripleBuffer<Mat> graphImages;
+    RenderScheduler<GraphState> graphScheduler(graphFps, [&](const GraphState& state) {
+        FER_TRACE_SCOPE("graph");
+        probabilityGraph.render(state.history, state.trackId).copyTo(graphImages.writeBuffer());
+        graphImages.publish();
+    });
+
+    thread captureThread([&] {
+        FER_TRACE_THREAD("capture");
+        while (running.load(memory_order_relaxed)) {
+            // A fresh Mat per frame: the previous one may still be in use downstream.
+            // Its buffer is a pool slot, released when the last stage drops the frame.
+            CapturedFrame frame;
+            frame.image.allocator = &imagePool;
+            {
+                FER_TRACE_SCOPE("capture");
+                if (!capture.read(frame.image) || frame.image.empty())
+                    break;
+            }
+            frame.captured = chrono::steady_clock::now();
+            capturedFrames.tryPush(std::move(frame));
+        }
+        capturedFrames.close();
+    });
 
-    while (capture.read(image) && !image.empty()) {
-        cvtColor(image, gray, COLOR_BGR2GRAY);
-        equalizeHist(gray, gray);
-        classifier.detectMultiScale(gray, features, 1.1, 5, 0 | CASCADE_SCALE_IMAGE, Size(30, 30));
-        drawDetectedFeatures(image, features);
-        if (!features.empty()) {
-            Mat face = gray(features[0]);
-            vector<float> probabilities = face2Int(face, predictor);
-            if (probabilities.empty()) {
-                imshow(window_name, image);
-                continue;
+    thread detectionThread([&] {
+        // Full cascade every detectInterval frames, ROI redetect / template tracking in between.
+        FER_TRACE_THREAD("detection");
+        FaceTracker tracker(detection);
+        CapturedFrame captured;
+        while (capturedFrames.popLatest(captured)) {
+            DetectedFrame frame;
+            frame.image = std::move(captured.image);
+            frame.captured = captured.captured;
+            frame.gray.allocator = &grayPool;
+            {
+                FER_TRACE_SCOPE("equalizeHist");
+                cvtColor(frame.image, frame.gray, COLOR_BGR2GRAY);
+                equalizeHist(frame.gray, frame.gray);
+            }
+            {
+                FER_TRACE_SCOPE("detectMultiScale");
+                frame.features = tracker.update(frame.gray, *detector);
             }
+            detectedFrames.tryPush(std::move(frame));
+        }
+        detectedFrames.close();
+        cerr << "Detection (" << detector->name() << "): " << tracker.stats() << "\n";
+    });
 
-            // Adjust probabilities (e.g., boost neutral) then smooth.
-            EmotionProbabilityAdjuster adjuster(2.0f);
-            vector<float> adjustedProbabilities = adjuster.adjust(probabilities);
+    thread inferenceThread([&] {
+        FER_TRACE_THREAD("inference");
+        SmoothingSettings smoothingSettings;
+        smoothingSettings.neutralBoost = 2.0f;
+        smoothingSettings.emaAlpha = 0.1f;
+        smoothingSettings.ringBufferSize = maxHistory;
+        smoothingSettings.framesForAverage = maxHistory;
+        if (historyLevels > 0) {
+            smoothingSettings.historyPrecision = HistoryPrecision::fixed16;
+            smoothingSettings.historyLevels = historyLevels;
+        }
+        SmootherPool smoothers(maxFaces, numClasses, neutralIndex, smoothingSettings);
+        vector<FaceBox> faceBoxes;
+        vector<int> faceSlots;
+        faceBoxes.reserve(maxFaces);
+        faceSlots.reserve(maxFaces);
+        // Every tracked face of a frame goes through the model in one batch.
+        FaceBatch batch(maxFaces, imageHeight, imageWidth, imageChannels);
+        vector<size_t> batchFaces;
+        batchFaces.reserve(maxFaces);
+        vector<float> batchProbabilities(maxFaces * numClasses);
+        // Infer less often while the followed face's expression holds still or frames pile up.
+        RateControlSettings rateSettings;
+        rateSettings.backlogLimit = 1;
+        InferenceRateController rate(rateSettings);
+        uint32_t followedTrack = 0;
+        uint64_t droppedBefore = 0;
+        // Raw and smoothed probabilities of each inferred face, for replaying with other settings.
+        unique_ptr<SessionWriter> recording;
+        const auto sessionStart = chrono::steady_clock::now();
+        uint32_t frameIndex = 0;
+        if (!recordingPath.empty()) {
+            const auto wallClock = chrono::system_clock::now().time_since_epoch();
+            recording = make_unique<SessionWriter>(recordingPath, numClasses, false,
+                chrono::duration_cast<chrono::nanoseconds>(wallClock).count());
+            if (!recording->isOpen()) {
+                cerr << "Cannot open session recording: " << recordingPath << "\n";
+                recording.reset();
+            }
+        }
 
-            vector<float> ema_probs = applyEma(adjustedProbabilities, ema_state, ema_alpha);
-            history.push_back(ema_probs);
-            if (history.size() > maxHistory) history.pop_front();
+        DetectedFrame detected;
+        while (detectedFrames.popLatest(detected)) {
+            frameIndex++;
+            RenderFrame frame;
+            const vector<Rect>& features = detected.features;
+            const size_t faceCount = min(features.size(), maxFaces);
+            frame.trackIds.assign(faceCount, 0);
+            if (faceCount > 0) {
+                // Match detections to tracks so each face keeps its own smoothing state.
+                faceBoxes.resize(faceCount);
+                faceSlots.resize(faceCount);
+                for (size_t i = 0; i < faceCount; i++)
+                    faceBoxes[i] = toFaceBox(features[i]);
+                smoothers.update(faceBoxes, faceSlots);
 
-            vector<float> median_probs = medianFromHistory(history);
-            const vector<float>& display_probs = median_probs.empty() ? ema_probs : median_probs;
+                // The graph and the rate controller follow the largest face, like the iOS predictor.
+                const size_t primary = static_cast<size_t>(max_element(features.begin(), features.begin() + faceCount,
+                    [](const Rect& a, const Rect& b) { return a.area() < b.area(); }) - features.begin());
+                const int primarySlot = faceSlots[primary];
+                const uint32_t primaryTrack = primarySlot != SmootherPool::kNoSlot ? smoothers.trackId(primarySlot) : 0;
+                if (primaryTrack != followedTrack) {
+                    rate.resetOutput();
+                    followedTrack = primaryTrack;
+                }
+                const uint64_t dropped = detectedFrames.dropped();
+                const bool infer = rate.shouldInfer(dropped - droppedBefore);
+                droppedBefore = dropped;
 
-            visualizeProbabilities(display_probs, classes, graph, history, maxHistory, randomColorsVec);
+                bool predicted = false;
+                if (infer) {
+                    FER_TRACE_SCOPE("inference");
+                    batch.clear();
+                    batchFaces.clear();
+                    for (size_t i = 0; i < faceCount; i++) {
+                        if (faceSlots[i] != SmootherPool::kNoSlot && batch.add(detected.gray, features[i]))
+                            batchFaces.push_back(i);
+                    }
+                    predicted = !batch.empty() && predictBatch(predictor, batch, batchProbabilities, numClasses);
+                }
+                if (predicted) {
+                    FER_TRACE_SCOPE("smoothing");
+                    for (size_t b = 0; b < batchFaces.size(); b++) {
+                        const size_t i = batchFaces[b];
+                        // Boost neutral, renormalize, EMA and median in one pass.
+                        const float* raw = &batchProbabilities[b * numClasses];
+                        const float* smoothed = smoothers.smoother(faceSlots[i]).push(raw);
+                        if (recording) {
+                            const Rect& face = features[i];
+                            const auto elapsed = chrono::steady_clock::now() - sessionStart;
+                            recording->append(chrono::duration_cast<chrono::nanoseconds>(elapsed).count(), frameIndex,
+                                smoothers.trackId(faceSlots[i]),
+                                { static_cast<float>(face.x), static_cast<float>(face.y),
+                                    static_cast<float>(face.width), static_cast<float>(face.height) },
+                                { raw, numClasses }, { smoothed, numClasses });
+                        }
+                    }
+                }
+                // Frames without inference keep the faces' last smoothed outputs.
+                for (size_t i = 0; i < faceCount; i++) {
+                    if (faceSlots[i] != SmootherPool::kNoSlot && !smoothers.smoother(faceSlots[i]).history().empty())
+                        frame.trackIds[i] = smoothers.trackId(faceSlots[i]);
+                }
+
+                if (predicted && primarySlot != SmootherPool::kNoSlot && !smoothers.smoother(primarySlot).history().empty()) {
+                    rate.observe(smoothers.smoother(primarySlot).output());
+                    // Publishing never waits on the graph thread; it keeps only the newest history.
+                    graphScheduler.publish([&](GraphState& state) {
+                        state.trackId = primaryTrack;
+                        state.history = smoothers.smoother(primarySlot).history();
+                    });
+                }
+            }
+            frame.image = std::move(detected.image);
+            frame.features = std::move(detected.features);
+            frame.captured = detected.captured;
+            frame.inferred = chrono::steady_clock::now();
+            renderFrames.tryPush(std::move(frame));
         }
-        imshow(window_name, image);
-        char key = (char)waitKey(10);
+        renderFrames.close();
+        cerr << "Inference rate: " << rate.stats() << "\n";
+        if (recording)
+            cerr << "Recorded " << recording->recordCount() << " faces to " << recordingPath << "\n";
+    });
+
+    namedWindow("Probabilities", WINDOW_NORMAL);
+
+    // One series per stage queue, named like the drop counts printed on exit.
+    PipelineTelemetry telemetry({ "capture", "detection", "render" }, stageQueueSize, telemetryWindow);
+    bool showTelemetry = false;
+
+    FER_TRACE_THREAD("render");
+    RenderFrame frame;
+    while (renderFrames.popLatest(frame)) {
+        FER_TRACE_SCOPE("visualization");
+        drawDetectedFeatures(frame.image, frame.features);
+        for (size_t i = 0; i < frame.trackIds.size(); i++) {
+            if (frame.trackIds[i] != 0)
+                drawTrackId(frame.image, frame.features[i], frame.trackIds[i]);
+        }
+        if (showTelemetry)
+            drawTelemetryOverlay(frame.image, telemetry.snapshot(chrono::steady_clock::now()));
+        if (graphImages.update())
+            imshow("Probabilities", graphImages.readBuffer());
+        imshow(window_name, frame.image);
+        // waitKey() paints the window, so the frame is on screen once it returns.
+        char key = (char)waitKey(1);
+        const auto shown = chrono::steady_clock::now();
+        telemetry.recordFrame(frame.captured, frame.inferred, shown);
+        telemetry.sampleStage(0, capturedFrames.dropped(), capturedFrames.size(), shown);
+        telemetry.sampleStage(1, detectedFrames.dropped(), detectedFrames.size(), shown);
+        telemetry.sampleStage(2, renderFrames.dropped(), renderFrames.size(), shown);
+        if (key == 't' || key == 'T')
+            showTelemetry = !showTelemetry;
         if (key == 'q' || key == 'Q')
             break;
     }
+
+    running.store(false, memory_order_relaxed);
+    captureThread.join();
+    detectionThread.join();
+    inferenceThread.join();
+    graphScheduler.stop();
+    cerr << "Frames dropped: capture " << capturedFrames.dropped() << ", detection " << detectedFrames.dropped()
+         << ", render " << renderFrames.dropped() << "\n";
+    cerr << "Telemetry, " << telemetry.snapshot(chrono::steady_clock::now()) << "\n";
+    cerr << "Frame pools: images " << imagePool.stats() << "; gray " << grayPool.stats() << "\n";
+    cerr << "Graph: " << graphScheduler.rendered() << " redraws for " << graphScheduler.published()
+         << " updates (cap " << graphFps << " fps)\n";
+#if FER_TRACING
+    for (const TraceCounter& stage : TraceRegistry::instance().summary()) {
+        cerr << "Trace " << stage.name << ": " << stage.count << " calls, mean " << stage.meanMs()
+             << " ms, max " << stage.maxMs() << " ms\n";
+    }
+    if (TraceRegistry::instance().writeChromeTrace(traceOutputPath))
+        cerr << "Trace written to " << traceOutputPath << " (open in chrome://tracing or ui.perfetto.dev)\n";
+#endif
 }
 
 int main(int argc, char** argv) {
-    if (argc != 3) {
-        cerr << "Usage: " << argv[0] << " <cascade.xml> <model.mlpackage>\n";
+    if (argc < 3 || argc > 10) {
+        cerr << "Usage: " << argv[0]
+             << " <cascade.xml|tiled[N]:cascade.xml|dnn:model[:config]> <model.mlpackage> [detect-every-N] [roi-margin] [detection-scale] [graph-fps]"
+                " [session.fers] [history-levels] [min-face-size]\n";
         return EXIT_FAILURE;
     }
-    captureVideoAndProcess(argv[1], argv[2]);
+    DetectionSettings detection;
+    if (argc > 3)
+        detection.detectInterval = static_cast<size_t>(max(1, atoi(argv[3])));
+    if (argc > 4)
+        detection.roiMargin = max(0.0, atof(argv[4]));
+    if (argc > 5)
+        detection.detectionScale = atof(argv[5]);
+    // Smallest face to find, in full-resolution pixels; it also bounds the detection scale.
+    if (argc > 9) {
+        const int minFace = max(1, atoi(argv[9]));
+        detection.minSize = Size(minFace, minFace);
+    }
+    const double scale = effectiveDetectionScale(detection);
+    if (scale > detection.detectionScale) {
+        cerr << "Warning: detection scale " << detection.detectionScale << " raised to " << scale << " so "
+             << detection.minSize.width << " px faces still cover the detector's " << detection.detectorWindow.width
+             << " px window; a larger min-face-size allows more downscaling\n";
+    }
+    // Downscaling is opt-in; when it applies, measure what the scaled pass misses against a
+    // full-resolution pass every 30 detections.
+    if (scale < 1.0)
+        detection.recallCheckInterval = 30;
+    const double graphFps = argc > 6 ? max(1.0, atof(argv[6])) : defaultGraphFps;
+    // "" or "-" records nothing, so history-levels can be given without a recording.
+    const string recordingPath = argc > 7 && string(argv[7]) != "-" ? argv[7] : "";
+    const size_t historyLevels = argc > 8 ? static_cast<size_t>(clamp(atoi(argv[8]), 0, 8)) : 0;
+    captureVideoAndProcess(argv[1], argv[2], detection, graphFps, recordingPath, historyLevels);
     return EXIT_SUCCESS;
 }
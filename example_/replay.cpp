@@ -0,0 +1,100 @@
+// Replays a recorded session (SessionRecording.h) through the smoothing chain.
+//
+//   g++ -O2 -march=native -std=c++20 replay.cpp -o replay
+//   ./replay <session.fers> [neutral-boost] [ema-alpha] [median-window] [passes] [history-bits]
+//
+// The file is memory mapped and each record's raw probabilities are pushed through a
+// SmoothingPipeline per track ID, so new smoothing settings can be tried against a real
+// session without recapturing video. Reports throughput and how far the replayed outputs are
+// from the smoothed outputs that were recorded live. history-bits 16 or 8 replays with the
+// compact fixed-point history, which shows its quantization error on real data.
+// Needs no OpenCV or CoreML.
+
+#include "SessionRecording.h"
+#include "SmoothingPipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+constexpr size_t neutralIndex = 3;
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 7) {
+        cerr << "Usage: " << argv[0]
+             << " <session.fers> [neutral-boost] [ema-alpha] [median-window] [passes] [history-bits]\n";
+        return EXIT_FAILURE;
+    }
+    SessionReader session(argv[1]);
+    if (!session.isValid()) {
+        cerr << "Not a session recording: " << argv[1] << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // Defaults match the live settings in main.cpp.
+    SmoothingSettings settings;
+    settings.neutralBoost = argc > 2 ? static_cast<float>(atof(argv[2])) : 2.0f;
+    settings.emaAlpha = argc > 3 ? static_cast<float>(atof(argv[3])) : 0.1f;
+    settings.framesForAverage = argc > 4 ? static_cast<size_t>(max(1, atoi(argv[4]))) : 60;
+    settings.ringBufferSize = max<size_t>(60, settings.framesForAverage);
+    const int passes = argc > 5 ? max(1, atoi(argv[5])) : 1;
+    const int historyBits = argc > 6 ? atoi(argv[6]) : 32;
+    settings.historyPrecision = historyBits == 8 ? HistoryPrecision::fixed8
+        : historyBits == 16                      ? HistoryPrecision::fixed16
+                                                 : HistoryPrecision::float32;
+
+    const size_t numClasses = session.numClasses();
+    if (!SmoothingPipeline::supports(numClasses, neutralIndex)) {
+        cerr << "Cannot smooth " << numClasses << " classes (1-" << kSmoothingLanes << " with neutral at "
+             << neutralIndex << "): " << argv[1] << "\n";
+        return EXIT_FAILURE;
+    }
+    const bool halfs = session.sessionHeader().flags & kSessionFloat16;
+    cerr << session.size() << " records, " << numClasses << " classes, " << (halfs ? "float16" : "float32")
+         << ", " << session.bytes() / (1024.0 * 1024.0) << " MiB\n";
+
+    unordered_map<uint32_t, SmoothingPipeline> pipelines;
+    vector<float> raw(numClasses), recorded(numClasses);
+    double maxDifference = 0, sumDifference = 0;
+    size_t compared = 0;
+
+    const auto start = chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        pipelines.clear();
+        for (size_t r = 0; r < session.size(); r++) {
+            const SessionRecordView record = session[r];
+            auto it = pipelines.find(record.trackId());
+            if (it == pipelines.end())
+                it = pipelines.try_emplace(record.trackId(), numClasses, neutralIndex, settings).first;
+            record.copyRaw(raw);
+            it->second.push(raw.data());
+
+            // Only the last pass compares, so timing covers the same work on every pass.
+            if (pass + 1 == passes) {
+                record.copySmoothed(recorded);
+                const span<const float> output = it->second.output();
+                for (size_t c = 0; c < output.size(); c++) {
+                    const double difference = abs(output[c] - recorded[c]);
+                    maxDifference = max(maxDifference, difference);
+                    sumDifference += difference;
+                }
+                compared += output.size();
+            }
+        }
+    }
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    const double records = static_cast<double>(session.size()) * passes;
+    cerr << "Replayed " << records << " records over " << pipelines.size() << " tracks in " << seconds * 1000
+         << " ms (" << records / seconds / 1e6 << " M records/s, "
+         << records * session.sessionHeader().recordSize / seconds / 1e9 << " GB/s)\n";
+    cerr << "Difference from recorded output: mean " << (compared ? sumDifference / compared : 0) << ", max "
+         << maxDifference << " (history quantization bound " << historyQuantizationError(settings.historyPrecision)
+         << ")\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,334 @@
+#include "SmootherPool.h"
+#include "FaceBatch.h"
+#include "FaceTracker.h"
+#include "LatencyStats.h"
+#include "StreamScheduler.h"
+#include "FaceDetector.h"
+#include "CoreMLBridge.h"
+#include <iostream>
+#include <iomanip>
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace cv;
+
+// Headless multi-stream engine: many camera / RTSP / file feeds in one process.
+//
+//   server <detector> <model.mlpackage> [--detect-threads N] [--detect-batch N] [--batch-faces N]
+//          [--report-seconds S] [--seconds S] <source...>
+//
+// The detector is a cascade XML, tiled[N]:<cascade.xml> or dnn:<model>[:<config>] (see
+// makeFaceDetector). With --detect-batch N and a batching backend (dnn), each detection
+// worker runs one forward pass over the newest frames of up to N streams and skips the
+// per-stream tracker.
+//
+// A source is a camera index ("0"), an RTSP / HTTP URL or a video file (played at its own
+// frame rate, like a live feed). Each source has a capture thread; detection runs on a
+// shared pool of threads and inference on one thread that packs the faces of several
+// streams into each model launch. Smoothing and tracking state stays per stream.
+// Both shared stages take streams round-robin through a StreamScheduler that keeps only
+// the newest frame per stream, so a stream with many faces or a high frame rate drops its
+// own stale frames instead of delaying the others.
+// Per-stream throughput, drops and capture-to-result latency are reported every
+// --report-seconds and at exit (Ctrl-C or --seconds).
+
+const vector<string> classes = { "fear", "angry", "sad", "neutral", "surprise", "disgust", "happy" };
+constexpr int64_t imageHeight = 128, imageWidth = 128, numClasses = 7;
+constexpr int imageChannels = 3;
+constexpr size_t neutralIndex = 3;
+constexpr int maxHistory = 60;
+constexpr size_t maxFacesPerStream = 16;
+constexpr size_t defaultBatchFaces = 16;
+constexpr double defaultReportSeconds = 10;
+constexpr size_t expectedLatencySamples = 1 << 16;
+
+static volatile sig_atomic_t interrupted = 0;
+
+struct CapturedFrame {
+    Mat image;
+    chrono::steady_clock::time_point capturedAt;
+};
+
+struct DetectedFrame {
+    Mat gray;
+    vector<Rect> features;
+    chrono::steady_clock::time_point capturedAt;
+};
+
+// Everything one feed owns. The capture fields belong to its capture thread, the tracker to
+// whichever detection worker holds the stream, the rest to the inference thread.
+struct Stream {
+    string source;
+    VideoCapture capture;
+    double pacingFps = 0;  // Files are read at their frame rate; 0 for live sources.
+    FaceTracker tracker;
+    SmootherPool smoothers;
+    LatencyRecorder latency;
+    uint64_t inferredFrames = 0;
+    uint64_t inferredFaces = 0;
+
+    Stream(string path, const DetectionSettings& detection, const SmoothingSettings& smoothing)
+        : source(std::move(path)), tracker(detection), smoothers(maxFacesPerStream, numClasses, neutralIndex, smoothing),
+          latency("latency", expectedLatencySamples) {}
+};
+
+bool openSource(Stream& stream) {
+    const string& source = stream.source;
+    if (!source.empty() && all_of(source.begin(), source.end(), [](unsigned char c) { return isdigit(c); }))
+        return stream.capture.open(atoi(source.c_str()));
+    if (!stream.capture.open(source))
+        return false;
+    if (filesystem::is_regular_file(source)) {
+        const double fps = stream.capture.get(CAP_PROP_FPS);
+        stream.pacingFps = fps > 0 ? fps : 30;
+    }
+    return true;
+}
+
+FaceBox toFaceBox(const Rect& r) {
+    return { static_cast<float>(r.x), static_cast<float>(r.y), static_cast<float>(r.width), static_cast<float>(r.height) };
+}
+
+void printReport(const vector<unique_ptr<Stream>>& streams, const StreamScheduler<CapturedFrame>& captured,
+    const StreamScheduler<DetectedFrame>& detected, double seconds) {
+    cerr << fixed << setprecision(1);
+    cerr << "After " << seconds << " s:\n";
+    for (size_t s = 0; s < streams.size(); s++) {
+        const Stream& stream = *streams[s];
+        const StreamQueueStats detection = captured.stats(s);
+        const StreamQueueStats inference = detected.stats(s);
+        const double perSecond = seconds > 0 ? 1.0 / seconds : 0;
+        cerr << "  [" << s << "] " << stream.source << ": " << detection.submitted * perSecond << " fps in, "
+             << inference.submitted * perSecond << " detected, " << stream.inferredFrames * perSecond << " inferred ("
+             << stream.inferredFaces << " faces); dropped " << detection.replaced << " before detection, "
+             << inference.replaced << " before inference; latency p50 " << stream.latency.percentile(50) << " ms, p95 "
+             << stream.latency.percentile(95) << " ms, p99 " << stream.latency.percentile(99) << " ms\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t detectThreads = max<size_t>(1, thread::hardware_concurrency() / 2);
+    size_t detectBatch = 1;
+    size_t batchFaces = defaultBatchFaces;
+    double reportSeconds = defaultReportSeconds;
+    double runSeconds = 0;
+    vector<string> sources;
+    bool badOption = false;
+    for (int i = 3; i < argc; i++) {
+        const string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--detect-threads" && hasValue)
+            detectThreads = static_cast<size_t>(max(1, atoi(argv[++i])));
+        else if (arg == "--detect-batch" && hasValue)
+            detectBatch = static_cast<size_t>(max(1, atoi(argv[++i])));
+        else if (arg == "--batch-faces" && hasValue)
+            batchFaces = static_cast<size_t>(max(1, atoi(argv[++i])));
+        else if (arg == "--report-seconds" && hasValue)
+            reportSeconds = max(1.0, atof(argv[++i]));
+        else if (arg == "--seconds" && hasValue)
+            runSeconds = max(0.0, atof(argv[++i]));
+        else if (arg.rfind("--", 0) == 0)
+            badOption = true;
+        else
+            sources.push_back(arg);
+    }
+    if (argc < 4 || badOption || sources.empty()) {
+        cerr << "Usage: " << argv[0] << " <detector> <model.mlpackage> [--detect-threads N] [--detect-batch N]"
+                " [--batch-faces N] [--report-seconds S] [--seconds S] <source...>\n"
+                "  detector: <cascade.xml> | tiled[N]:<cascade.xml> | dnn:<model>[:<config>]\n";
+        return EXIT_FAILURE;
+    }
+
+    DetectionSettings detection;
+    SmoothingSettings smoothing;
+    smoothing.neutralBoost = 2.0f;
+    smoothing.emaAlpha = 0.1f;
+    smoothing.ringBufferSize = maxHistory;
+    smoothing.framesForAverage = maxHistory;
+    vector<unique_ptr<Stream>> streams;
+    for (const string& source : sources) {
+        streams.push_back(make_unique<Stream>(source, detection, smoothing));
+        if (!openSource(*streams.back())) {
+            cerr << "Cannot open source: " << source << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Detectors are not shared between threads: every detection worker loads its own.
+    vector<unique_ptr<FaceDetector>> detectors;
+    for (size_t w = 0; w < detectThreads; w++) {
+        detectors.push_back(makeFaceDetector(argv[1]));
+        if (!detectors.back()) {
+            cerr << "Error loading detector from: " << argv[1] << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    const bool batchedDetection = detectBatch > 1 && detectors.front()->batches();
+    cerr << "Detector: " << detectors.front()->name() << " on " << detectThreads << " threads"
+         << (batchedDetection ? ", batches of up to " + to_string(detectBatch) + " streams" : "") << "\n";
+    FERPredictor predictor(argv[2]);
+
+    StreamScheduler<CapturedFrame> capturedFrames(streams.size());
+    StreamScheduler<DetectedFrame> detectedFrames(streams.size());
+    atomic<bool> running{ true };
+    atomic<size_t> liveStreams{ streams.size() };
+    signal(SIGINT, [](int) { interrupted = 1; });
+
+    const auto runStart = chrono::steady_clock::now();
+    vector<thread> captureThreads;
+    for (size_t s = 0; s < streams.size(); s++) {
+        captureThreads.emplace_back([&, s] {
+            Stream& stream = *streams[s];
+            const auto frameInterval = stream.pacingFps > 0
+                ? chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(1.0 / stream.pacingFps))
+                : chrono::steady_clock::duration::zero();
+            auto nextFrame = chrono::steady_clock::now();
+            while (running.load(memory_order_relaxed)) {
+                if (frameInterval.count() > 0) {
+                    this_thread::sleep_until(nextFrame);
+                    nextFrame += frameInterval;
+                }
+                CapturedFrame frame;
+                if (!stream.capture.read(frame.image) || frame.image.empty())
+                    break;
+                frame.capturedAt = chrono::steady_clock::now();
+                capturedFrames.submit(s, std::move(frame));
+            }
+            liveStreams.fetch_sub(1, memory_order_relaxed);
+            cerr << "[" << s << "] " << stream.source << ": end of stream\n";
+        });
+    }
+
+    vector<thread> detectionThreads;
+    for (size_t w = 0; w < detectThreads && batchedDetection; w++) {
+        detectionThreads.emplace_back([&, w] {
+            // Full-frame detection of several streams per forward pass; each frame counts as one.
+            vector<pair<size_t, CapturedFrame>> batch;
+            vector<Mat> grays;
+            vector<vector<Rect>> faces;
+            const DetectionParams params{ detection.scaleFactor, detection.minNeighbors, detection.minSize, Size() };
+            while (capturedFrames.acquireBatch(batch, detectBatch, [](const CapturedFrame&) { return size_t{ 1 }; })) {
+                grays.resize(batch.size());
+                faces.resize(batch.size());
+                for (size_t b = 0; b < batch.size(); b++) {
+                    cvtColor(batch[b].second.image, grays[b], COLOR_BGR2GRAY);
+                    equalizeHist(grays[b], grays[b]);
+                }
+                detectors[w]->detectBatch(grays, faces, params);
+                for (size_t b = 0; b < batch.size(); b++) {
+                    const size_t s = batch[b].first;
+                    batch[b].second.image.release();
+                    capturedFrames.done(s);
+                    // The gray Mat is handed on, so the next batch decodes into a fresh one.
+                    detectedFrames.submit(s, { std::move(grays[b]), std::move(faces[b]), batch[b].second.capturedAt });
+                    grays[b] = Mat();
+                    faces[b].clear();
+                }
+            }
+        });
+    }
+    for (size_t w = 0; w < detectThreads && !batchedDetection; w++) {
+        detectionThreads.emplace_back([&, w] {
+            size_t s;
+            CapturedFrame captured;
+            while (capturedFrames.acquire(s, captured)) {
+                DetectedFrame frame;
+                cvtColor(captured.image, frame.gray, COLOR_BGR2GRAY);
+                equalizeHist(frame.gray, frame.gray);
+                frame.features = streams[s]->tracker.update(frame.gray, *detectors[w]);
+                frame.capturedAt = captured.capturedAt;
+                captured.image.release();
+                capturedFrames.done(s);
+                detectedFrames.submit(s, std::move(frame));
+            }
+        });
+    }
+
+    thread inferenceThread([&] {
+        // One model launch for the faces of as many streams as fit in batchFaces.
+        FaceBatch batch(batchFaces, imageHeight, imageWidth, imageChannels);
+        vector<float> batchProbabilities(batchFaces * numClasses);
+        vector<pair<size_t, DetectedFrame>> frames;
+        vector<FaceBox> faceBoxes(maxFacesPerStream);
+        vector<vector<int>> faceSlots(streams.size(), vector<int>(maxFacesPerStream));
+        struct BatchEntry {
+            size_t frame;
+            int slot;
+        };
+        vector<BatchEntry> entries;
+        entries.reserve(batchFaces);
+        const auto faceCost = [&](const DetectedFrame& frame) {
+            return min({ frame.features.size(), maxFacesPerStream, batchFaces });
+        };
+        auto nextReport = runStart + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(reportSeconds));
+
+        while (detectedFrames.acquireBatch(frames, batchFaces, faceCost)) {
+            batch.clear();
+            entries.clear();
+            for (size_t f = 0; f < frames.size(); f++) {
+                auto& [s, frame] = frames[f];
+                const size_t faceCount = faceCost(frame);
+                for (size_t i = 0; i < faceCount; i++)
+                    faceBoxes[i] = toFaceBox(frame.features[i]);
+                span<int> slots(faceSlots[s].data(), faceCount);
+                streams[s]->smoothers.update(span<const FaceBox>(faceBoxes.data(), faceCount), slots);
+                for (size_t i = 0; i < faceCount; i++) {
+                    if (slots[i] != SmootherPool::kNoSlot && batch.add(frame.gray, frame.features[i]))
+                        entries.push_back({ f, slots[i] });
+                }
+            }
+
+            const bool predicted = !batch.empty() && predictBatch(predictor, batch, batchProbabilities, numClasses);
+            if (predicted) {
+                // Boost neutral, renormalize, EMA and median, each face with its own stream's smoother.
+                for (size_t b = 0; b < entries.size(); b++) {
+                    Stream& stream = *streams[frames[entries[b].frame].first];
+                    stream.smoothers.smoother(entries[b].slot).push(&batchProbabilities[b * numClasses]);
+                    stream.inferredFaces++;
+                }
+            }
+            const auto finished = chrono::steady_clock::now();
+            for (auto& [s, frame] : frames) {
+                Stream& stream = *streams[s];
+                stream.inferredFrames++;
+                stream.latency.record(frame.capturedAt, finished);
+                detectedFrames.done(s);
+            }
+
+            if (finished >= nextReport) {
+                printReport(streams, capturedFrames, detectedFrames, chrono::duration<double>(finished - runStart).count());
+                nextReport += chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(reportSeconds));
+            }
+        }
+    });
+
+    // Run until every source ended, Ctrl-C or --seconds.
+    const auto deadline = runSeconds > 0
+        ? runStart + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(runSeconds))
+        : chrono::steady_clock::time_point::max();
+    while (liveStreams.load(memory_order_relaxed) > 0 && !interrupted && chrono::steady_clock::now() < deadline)
+        this_thread::sleep_for(chrono::milliseconds(50));
+
+    // Stop in pipeline order; frames still pending in a stage are dropped.
+    running.store(false, memory_order_relaxed);
+    for (thread& t : captureThreads)
+        t.join();
+    capturedFrames.close();
+    for (thread& t : detectionThreads)
+        t.join();
+    detectedFrames.close();
+    inferenceThread.join();
+    printReport(streams, capturedFrames, detectedFrames, chrono::duration<double>(chrono::steady_clock::now() - runStart).count());
+    for (size_t s = 0; s < streams.size() && !batchedDetection; s++)
+        cerr << "[" << s << "] Detection: " << streams[s]->tracker.stats() << "\n";
+    return EXIT_SUCCESS;
+}
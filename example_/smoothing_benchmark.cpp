@@ -0,0 +1,333 @@
+// Microbenchmarks for the smoothing primitives (Google Benchmark).
+//
+//   g++ -O2 -march=native -std=c++20 smoothing_benchmark.cpp -lbenchmark -lpthread -o smoothing_benchmark
+//
+// Each "Baseline" benchmark is a verbatim copy of the implementation the optimized variant
+// replaced (vector-returning adjust, applyEma, and medianFromHistory over a
+// deque<vector<float>>), so before/after numbers come from one binary. Arguments are swept
+// over history lengths {15, 60, 240, 1000}, face counts {1..32} and class counts {4, 7, 16};
+// the fused kernels and SmoothingPipeline are fixed to the 8-lane layout (classes <= 8).
+// Needs no OpenCV or CoreML.
+
+#include "ProbabilityAdjustment.h"
+#include "ProbabilityHistory.h"
+#include "RunningMedian.h"
+#include "SmoothingKernels.h"
+#include "SmoothingPipeline.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+constexpr size_t neutralIndex = 3;
+constexpr float boostFactor = 2.0f;
+constexpr float emaAlpha = 0.1f;
+constexpr size_t framePoolSize = 1024;
+
+const vector<int64_t> historyLengths = { 15, 60, 240, 1000 };
+const vector<int64_t> faceCounts = { 1, 2, 4, 8, 16, 32 };
+const vector<int64_t> classCounts = { 4, 7, 16 };
+
+// Deterministic pool of normalized random frames, cycled through by every benchmark.
+vector<float> makeFrames(size_t numClasses, size_t frames = framePoolSize) {
+    mt19937 gen(42);
+    uniform_real_distribution<float> dis(0.01f, 1.0f);
+    vector<float> pool(numClasses * frames);
+    for (size_t f = 0; f < frames; ++f) {
+        float sum = 0;
+        for (size_t c = 0; c < numClasses; ++c)
+            sum += pool[f * numClasses + c] = dis(gen);
+        for (size_t c = 0; c < numClasses; ++c)
+            pool[f * numClasses + c] /= sum;
+    }
+    return pool;
+}
+
+// MARK: - Baselines (pre-optimization implementations)
+
+vector<float> baselineAdjust(const vector<float>& probabilities, float boost, size_t neutral) {
+    vector<float> adjusted = probabilities;
+    if (adjusted.size() > neutral)
+        adjusted[neutral] *= boost;
+    float sum = accumulate(adjusted.begin(), adjusted.end(), 0.0f);
+    if (sum > 0) {
+        for (auto& p : adjusted)
+            p /= sum;
+    }
+    return adjusted;
+}
+
+vector<float> baselineApplyEma(const vector<float>& new_probs, vector<float>& ema_state, float alpha) {
+    if (ema_state.empty()) {
+        ema_state = new_probs;
+        return ema_state;
+    }
+    for (size_t i = 0; i < new_probs.size(); ++i)
+        ema_state[i] = alpha * new_probs[i] + (1.0f - alpha) * ema_state[i];
+    return ema_state;
+}
+
+vector<float> baselineMedianFromHistory(const deque<vector<float>>& history) {
+    if (history.empty()) return {};
+    size_t classesCount = history.front().size();
+    vector<float> medians(classesCount, 0.0f);
+    for (size_t c = 0; c < classesCount; ++c) {
+        vector<float> col;
+        col.reserve(history.size());
+        for (const auto& h : history) {
+            if (c < h.size()) col.push_back(h[c]);
+        }
+        if (!col.empty()) {
+            nth_element(col.begin(), col.begin() + col.size() / 2, col.end());
+            medians[c] = col[col.size() / 2];
+        }
+    }
+    return medians;
+}
+
+// MARK: - Neutral boost + renormalize
+
+// Args: faces, classes
+void BM_AdjustBaseline(benchmark::State& state) {
+    const size_t faces = state.range(0), classes = state.range(1);
+    const vector<float> pool = makeFrames(classes);
+    vector<vector<float>> rows(faces);
+    size_t frame = 0;
+    for (auto _ : state) {
+        for (size_t f = 0; f < faces; ++f, frame = (frame + 1) % framePoolSize) {
+            const vector<float> input(pool.begin() + frame * classes, pool.begin() + (frame + 1) * classes);
+            rows[f] = baselineAdjust(input, boostFactor, neutralIndex);
+        }
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(state.iterations() * faces);
+}
+
+void BM_AdjustInPlace(benchmark::State& state) {
+    const size_t faces = state.range(0), classes = state.range(1);
+    const vector<float> pool = makeFrames(classes);
+    const EmotionProbabilityAdjuster adjuster(boostFactor, neutralIndex);
+    vector<float> rows(faces * classes);
+    size_t frame = 0;
+    for (auto _ : state) {
+        for (size_t f = 0; f < faces; ++f, frame = (frame + 1) % framePoolSize) {
+            copy_n(pool.begin() + frame * classes, classes, rows.begin() + f * classes);
+            adjuster.adjust(span<float>(rows.data() + f * classes, classes));
+        }
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(state.iterations() * faces);
+}
+
+void BM_AdjustBatch(benchmark::State& state) {
+    const size_t faces = state.range(0), classes = state.range(1);
+    const vector<float> pool = makeFrames(classes);
+    const EmotionProbabilityAdjuster adjuster(boostFactor, neutralIndex);
+    vector<float> rows(faces * classes);
+    size_t frame = 0;
+    for (auto _ : state) {
+        const size_t start = frame;
+        frame = (frame + faces) % (framePoolSize - faces);
+        copy_n(pool.begin() + start * classes, faces * classes, rows.begin());
+        adjuster.adjustBatch(rows, classes);
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(state.iterations() * faces);
+}
+
+// Args: faces (7 classes)
+void BM_AdjustFixed(benchmark::State& state) {
+    const size_t faces = state.range(0);
+    const vector<float> pool = makeFrames(7);
+    constexpr FixedEmotionProbabilityAdjuster<7, neutralIndex> adjuster(boostFactor);
+    vector<array<float, 7>> rows(faces);
+    size_t frame = 0;
+    for (auto _ : state) {
+        for (size_t f = 0; f < faces; ++f, frame = (frame + 1) % framePoolSize) {
+            array<float, 7> p;
+            copy_n(pool.begin() + frame * 7, 7, p.begin());
+            rows[f] = adjuster.adjust(p);
+        }
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(state.iterations() * faces);
+}
+
+// MARK: - Boost + renormalize + EMA
+
+// Args: faces, classes
+void BM_AdjustEmaBaseline(benchmark::State& state) {
+    const size_t faces = state.range(0), classes = state.range(1);
+    const vector<float> pool = makeFrames(classes);
+    vector<vector<float>> emaStates(faces), outputs(faces);
+    size_t frame = 0;
+    for (auto _ : state) {
+        for (size_t f = 0; f < faces; ++f, frame = (frame + 1) % framePoolSize) {
+            const vector<float> input(pool.begin() + frame * classes, pool.begin() + (frame + 1) * classes);
+            outputs[f] = baselineApplyEma(baselineAdjust(input, boostFactor, neutralIndex), emaStates[f], emaAlpha);
+        }
+        benchmark::DoNotOptimize(outputs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * faces);
+}
+
+// Args: faces (8-lane layout, 7 classes)
+template <void (*Kernel)(float*, float*, const float*, size_t, size_t, float)>
+void BM_FusedSmooth(benchmark::State& state) {
+    const size_t faces = state.range(0);
+    const vector<float> pool = makeFrames(7);
+    vector<float> probs(faces * kSmoothingLanes, 0.0f), ema(faces * kSmoothingLanes, 0.0f);
+    const vector<float> alphas(faces, emaAlpha);
+    size_t frame = 0;
+    for (auto _ : state) {
+        for (size_t f = 0; f < faces; ++f, frame = (frame + 1) % framePoolSize)
+            copy_n(pool.begin() + frame * 7, 7, probs.begin() + f * kSmoothingLanes);
+        Kernel(probs.data(), ema.data(), alphas.data(), faces, neutralIndex, boostFactor);
+        benchmark::DoNotOptimize(ema.data());
+    }
+    state.SetItemsProcessed(state.iterations() * faces);
+}
+
+// MARK: - History + median
+
+// Args: history, classes. Steady state: the window is full before timing starts.
+void BM_MedianBaseline(benchmark::State& state) {
+    const size_t window = state.range(0), classes = state.range(1);
+    const vector<float> pool = makeFrames(classes);
+    deque<vector<float>> history;
+    size_t frame = 0;
+    auto push = [&] {
+        history.emplace_back(pool.begin() + frame * classes, pool.begin() + (frame + 1) * classes);
+        if (history.size() > window)
+            history.pop_front();
+        frame = (frame + 1) % framePoolSize;
+    };
+    for (size_t i = 0; i < window; ++i)
+        push();
+    for (auto _ : state) {
+        push();
+        vector<float> medians = baselineMedianFromHistory(history);
+        benchmark::DoNotOptimize(medians.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_RunningMedian(benchmark::State& state) {
+    const size_t window = state.range(0), classes = state.range(1);
+    const vector<float> pool = makeFrames(classes);
+    RunningMedian median(classes, window);
+    vector<float> medians(classes);
+    size_t frame = 0;
+    auto push = [&] {
+        median.push(span<const float>(pool.data() + frame * classes, classes));
+        frame = (frame + 1) % framePoolSize;
+    };
+    for (size_t i = 0; i < window; ++i)
+        push();
+    for (auto _ : state) {
+        push();
+        median.median(medians);
+        benchmark::DoNotOptimize(medians.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Args: history, classes
+void BM_HistoryPushDeque(benchmark::State& state) {
+    const size_t window = state.range(0), classes = state.range(1);
+    const vector<float> pool = makeFrames(classes);
+    deque<vector<float>> history;
+    size_t frame = 0;
+    for (auto _ : state) {
+        history.emplace_back(pool.begin() + frame * classes, pool.begin() + (frame + 1) * classes);
+        if (history.size() > window)
+            history.pop_front();
+        frame = (frame + 1) % framePoolSize;
+        benchmark::DoNotOptimize(history.back().data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_HistoryPushRing(benchmark::State& state) {
+    const size_t window = state.range(0), classes = state.range(1);
+    const vector<float> pool = makeFrames(classes);
+    ProbabilityHistory history(classes, window);
+    size_t frame = 0;
+    for (auto _ : state) {
+        history.push(span<const float>(pool.data() + frame * classes, classes));
+        frame = (frame + 1) % framePoolSize;
+        benchmark::DoNotOptimize(history.latest(0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// MARK: - Whole per-frame chain
+
+// Args: history, faces (7 classes)
+void BM_ChainBaseline(benchmark::State& state) {
+    const size_t window = state.range(0), faces = state.range(1);
+    const vector<float> pool = makeFrames(7);
+    vector<vector<float>> emaStates(faces);
+    vector<deque<vector<float>>> histories(faces);
+    size_t frame = 0;
+    for (auto _ : state) {
+        for (size_t f = 0; f < faces; ++f, frame = (frame + 1) % framePoolSize) {
+            const vector<float> input(pool.begin() + frame * 7, pool.begin() + (frame + 1) * 7);
+            vector<float> smoothed = baselineApplyEma(baselineAdjust(input, boostFactor, neutralIndex), emaStates[f], emaAlpha);
+            histories[f].push_back(std::move(smoothed));
+            if (histories[f].size() > window)
+                histories[f].pop_front();
+            vector<float> medians = baselineMedianFromHistory(histories[f]);
+            benchmark::DoNotOptimize(medians.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * faces);
+}
+
+void BM_SmoothingPipeline(benchmark::State& state) {
+    const size_t window = state.range(0), faces = state.range(1);
+    const vector<float> pool = makeFrames(7);
+    SmoothingSettings settings;
+    settings.neutralBoost = boostFactor;
+    settings.emaAlpha = emaAlpha;
+    settings.ringBufferSize = window;
+    settings.framesForAverage = window;
+    vector<SmoothingPipeline> pipelines;
+    pipelines.reserve(faces);
+    for (size_t f = 0; f < faces; ++f)
+        pipelines.emplace_back(7, neutralIndex, settings);
+    size_t frame = 0;
+    for (auto _ : state) {
+        for (size_t f = 0; f < faces; ++f, frame = (frame + 1) % framePoolSize)
+            benchmark::DoNotOptimize(pipelines[f].push(pool.data() + frame * 7));
+    }
+    state.SetItemsProcessed(state.iterations() * faces);
+}
+
+}  // namespace
+
+BENCHMARK(BM_AdjustBaseline)->ArgsProduct({ faceCounts, classCounts });
+BENCHMARK(BM_AdjustInPlace)->ArgsProduct({ faceCounts, classCounts });
+BENCHMARK(BM_AdjustBatch)->ArgsProduct({ faceCounts, classCounts });
+BENCHMARK(BM_AdjustFixed)->ArgsProduct({ faceCounts });
+
+BENCHMARK(BM_AdjustEmaBaseline)->ArgsProduct({ faceCounts, classCounts });
+BENCHMARK(BM_FusedSmooth<fusedSmoothScalar>)->Name("BM_FusedSmooth/scalar")->ArgsProduct({ faceCounts });
+BENCHMARK(BM_FusedSmooth<fusedSmooth>)->Name(string("BM_FusedSmooth/") + fusedSmoothKernelName())->ArgsProduct({ faceCounts });
+
+BENCHMARK(BM_MedianBaseline)->ArgsProduct({ historyLengths, classCounts });
+BENCHMARK(BM_RunningMedian)->ArgsProduct({ historyLengths, classCounts });
+BENCHMARK(BM_HistoryPushDeque)->ArgsProduct({ historyLengths, classCounts });
+BENCHMARK(BM_HistoryPushRing)->ArgsProduct({ historyLengths, classCounts });
+
+BENCHMARK(BM_ChainBaseline)->ArgsProduct({ historyLengths, faceCounts });
+BENCHMARK(BM_SmoothingPipeline)->ArgsProduct({ historyLengths, faceCounts });
+
+BENCHMARK_MAIN();
@@ -0,0 +1,258 @@
+// Sweeps smoothing settings over recorded sessions (SessionRecording.h) on every core.
+//
+//   g++ -O2 -march=native -std=c++20 -pthread sweep.cpp -o sweep
+//   ./sweep [--boost 1,2,3] [--alpha 0.05,0.1] [--average 15,30]
+//           [--threads N] <session.fers>... > sweep.csv
+//
+// Every session is mapped and decoded once into per-track raw probability arrays, which all
+// workers then share read-only. Each configuration of the grid (neutral boost x EMA alpha x
+// median window, the InferenceSettings knobs) is one work item, scheduled with
+// WorkStealingPool since long medians cost far more than short ones.
+// The history length (ringBufferSize) is not swept: the smoothed output only depends on it
+// through medianWindow() = min(framesForAverage, ringBufferSize), so each configuration
+// keeps exactly framesForAverage frames of history.
+//
+// Per configuration, over every track:
+//   jitter         mean frame-to-frame change of the smoothed output (half the L1 distance)
+//   flips_per_min  changes of the smoothed dominant class per minute
+//   lag_ms         mean time from a sustained change of the raw dominant class (held for
+//                  sustainFrames records) until the smoothed output shows it
+//   missed         sustained raw changes the smoothed output never showed while they lasted
+//   pareto         1 when no other configuration is at least as good on flips, lag and
+//                  misses and better on one of them
+// Needs no OpenCV or CoreML.
+
+#include "SessionRecording.h"
+#include "SmoothingPipeline.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+constexpr size_t neutralIndex = 3;
+constexpr size_t sustainFrames = 5;
+
+// One face track of one session, decoded once.
+struct DecodedTrack {
+    size_t numClasses = 0;
+    vector<uint64_t> timestamps;
+    vector<float> raw;  // timestamps.size() x numClasses.
+
+    // Sustained changes of the raw dominant class: the record where the new class takes over
+    // and the record where it stops being dominant.
+    struct Transition {
+        size_t start, end;
+        size_t dominant;
+    };
+    vector<Transition> transitions;
+
+    size_t size() const { return timestamps.size(); }
+    const float* frame(size_t i) const { return &raw[i * numClasses]; }
+};
+
+struct SweepConfig {
+    float neutralBoost;
+    float emaAlpha;
+    size_t average;
+};
+
+struct SweepResult {
+    double jitter = 0;
+    double flipsPerMinute = 0;
+    double lagMs = 0;
+    size_t missed = 0;
+    bool pareto = false;
+};
+
+size_t dominantClass(const float* p, size_t n) {
+    return static_cast<size_t>(max_element(p, p + n) - p);
+}
+
+vector<float> parseList(const string& text) {
+    vector<float> values;
+    stringstream in(text);
+    string item;
+    while (getline(in, item, ','))
+        values.push_back(static_cast<float>(atof(item.c_str())));
+    return values;
+}
+
+void findTransitions(DecodedTrack& track) {
+    const size_t n = track.size();
+    size_t runStart = 0;
+    size_t previous = n ? dominantClass(track.frame(0), track.numClasses) : 0;
+    for (size_t i = 1; i <= n; i++) {
+        const size_t dominant = i < n ? dominantClass(track.frame(i), track.numClasses) : SIZE_MAX;
+        if (dominant == previous)
+            continue;
+        // The first run is the starting state, not a change.
+        if (runStart > 0 && i - runStart >= sustainFrames)
+            track.transitions.push_back({ runStart, i, previous });
+        runStart = i;
+        previous = dominant;
+    }
+}
+
+// Group a mapped session's records by track ID, in recording order.
+void decodeSession(const SessionReader& session, vector<DecodedTrack>& tracks) {
+    const size_t numClasses = session.numClasses();
+    map<uint32_t, DecodedTrack> byTrack;
+    for (size_t r = 0; r < session.size(); r++) {
+        const SessionRecordView record = session[r];
+        DecodedTrack& track = byTrack[record.trackId()];
+        track.numClasses = numClasses;
+        track.timestamps.push_back(record.timestampNs());
+        track.raw.resize(track.raw.size() + numClasses);
+        record.copyRaw(span<float>(track.raw).last(numClasses));
+    }
+    for (auto& [id, track] : byTrack) {
+        findTransitions(track);
+        tracks.push_back(std::move(track));
+    }
+}
+
+SweepResult evaluate(const SweepConfig& config, const vector<DecodedTrack>& tracks) {
+    SmoothingSettings settings;
+    settings.neutralBoost = config.neutralBoost;
+    settings.emaAlpha = config.emaAlpha;
+    settings.ringBufferSize = config.average;
+    settings.framesForAverage = config.average;
+
+    double change = 0, minutes = 0, lagNs = 0;
+    size_t frames = 0, flips = 0, caught = 0, missed = 0;
+    vector<size_t> smoothedDominant;
+    for (const DecodedTrack& track : tracks) {
+        if (track.size() < 2)
+            continue;
+        SmoothingPipeline pipeline(track.numClasses, neutralIndex, settings);
+        smoothedDominant.resize(track.size());
+        const float* first = pipeline.push(track.frame(0));
+        vector<float> previous(first, first + track.numClasses);
+        smoothedDominant[0] = dominantClass(previous.data(), track.numClasses);
+        for (size_t i = 1; i < track.size(); i++) {
+            const float* smoothed = pipeline.push(track.frame(i));
+            double distance = 0;
+            for (size_t c = 0; c < track.numClasses; c++) {
+                distance += abs(smoothed[c] - previous[c]);
+                previous[c] = smoothed[c];
+            }
+            change += distance / 2;
+            smoothedDominant[i] = dominantClass(smoothed, track.numClasses);
+            flips += smoothedDominant[i] != smoothedDominant[i - 1];
+        }
+        frames += track.size() - 1;
+        minutes += (track.timestamps.back() - track.timestamps.front()) / 60e9;
+
+        for (const DecodedTrack::Transition& t : track.transitions) {
+            const auto shown = find(smoothedDominant.begin() + t.start, smoothedDominant.begin() + t.end, t.dominant);
+            if (shown == smoothedDominant.begin() + t.end) {
+                missed++;
+                continue;
+            }
+            lagNs += track.timestamps[shown - smoothedDominant.begin()] - track.timestamps[t.start];
+            caught++;
+        }
+    }
+
+    SweepResult result;
+    result.jitter = frames ? change / frames : 0;
+    result.flipsPerMinute = minutes > 0 ? flips / minutes : 0;
+    result.lagMs = caught ? lagNs / caught / 1e6 : 0;
+    result.missed = missed;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    vector<float> boosts = { 1.0f, 1.5f, 2.0f, 2.5f, 3.0f };
+    vector<float> alphas = { 0.05f, 0.1f, 0.15f, 0.2f, 0.3f, 0.5f };
+    vector<float> averages = { 5, 10, 15, 30, 60, 120 };
+    size_t threads = 0;
+    vector<string> paths;
+    bool badOption = false;
+    for (int i = 1; i < argc; i++) {
+        const string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--boost" && hasValue)
+            boosts = parseList(argv[++i]);
+        else if (arg == "--alpha" && hasValue)
+            alphas = parseList(argv[++i]);
+        else if (arg == "--average" && hasValue)
+            averages = parseList(argv[++i]);
+        else if (arg == "--threads" && hasValue)
+            threads = static_cast<size_t>(max(0, atoi(argv[++i])));
+        else if (arg.rfind("--", 0) == 0)
+            badOption = true;
+        else
+            paths.push_back(arg);
+    }
+    if (paths.empty() || badOption) {
+        cerr << "Usage: " << argv[0] << " [--boost 1,2,3] [--alpha 0.05,0.1] [--average 15,30]"
+                " [--threads N] <session.fers>...\n";
+        return EXIT_FAILURE;
+    }
+
+    vector<DecodedTrack> tracks;
+    size_t records = 0;
+    for (const string& path : paths) {
+        SessionReader session(path);
+        if (!session.isValid()) {
+            cerr << "Not a session recording: " << path << "\n";
+            return EXIT_FAILURE;
+        }
+        if (!SmoothingPipeline::supports(session.numClasses(), neutralIndex)) {
+            cerr << "Cannot smooth " << session.numClasses() << " classes (1-" << kSmoothingLanes
+                 << " with neutral at " << neutralIndex << "): " << path << "\n";
+            return EXIT_FAILURE;
+        }
+        decodeSession(session, tracks);
+        records += session.size();
+    }
+    size_t transitions = 0;
+    for (const DecodedTrack& track : tracks)
+        transitions += track.transitions.size();
+
+    vector<SweepConfig> configs;
+    for (float boost : boosts)
+        for (float alpha : alphas)
+            for (float average : averages) {
+                if (average >= 1)
+                    configs.push_back({ boost, alpha, static_cast<size_t>(average) });
+            }
+
+    WorkStealingPool pool(threads);
+    cerr << records << " records in " << tracks.size() << " tracks (" << transitions << " sustained changes), "
+         << configs.size() << " configurations on " << pool.threads() << " threads\n";
+
+    vector<SweepResult> results(configs.size());
+    const auto start = chrono::steady_clock::now();
+    pool.parallelFor(configs.size(), [&](size_t index, size_t) { results[index] = evaluate(configs[index], tracks); });
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    for (size_t i = 0; i < results.size(); i++) {
+        results[i].pareto = none_of(results.begin(), results.end(), [&](const SweepResult& other) {
+            return other.flipsPerMinute <= results[i].flipsPerMinute && other.lagMs <= results[i].lagMs
+                && other.missed <= results[i].missed
+                && (other.flipsPerMinute < results[i].flipsPerMinute || other.lagMs < results[i].lagMs
+                    || other.missed < results[i].missed);
+        });
+    }
+
+    cout << "neutral_boost,ema_alpha,frames_for_average,jitter,flips_per_min,lag_ms,missed,pareto\n";
+    for (size_t i = 0; i < configs.size(); i++) {
+        const SweepConfig& c = configs[i];
+        const SweepResult& r = results[i];
+        cout << c.neutralBoost << "," << c.emaAlpha << "," << c.average << "," << r.jitter << ","
+             << r.flipsPerMinute << "," << r.lagMs << "," << r.missed << "," << r.pareto << "\n";
+    }
+    cerr << "Swept in " << seconds << " s (" << records * configs.size() / seconds / 1e6 << " M records/s, "
+         << pool.steals() << " steals)\n";
+    return EXIT_SUCCESS;
+}